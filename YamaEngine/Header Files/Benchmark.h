@@ -0,0 +1,219 @@
+#ifdef GAME
+#pragma once
+#include "nlohmann/json.hpp"
+import <array>;
+import <vector>;
+import <string>;
+import <atomic>;
+import <chrono>;
+import <fstream>;
+import <algorithm>;
+import <cmath>;
+import RunSettings;
+import Logger;
+
+// Unlike the profiling zones, the benchmark does not depend on the PROFILING build, so the numbers come from the same build that is shipped.
+// Phase times of a frame are summed up (e.g. over the sub-steps or over the sync tasks running on different threads), so they show the work done rather than the wall time.
+
+/**
+ * @brief Parts of the frame that are measured by the benchmark.
+*/
+enum class BenchmarkPhase
+{
+	Scripts,
+	PhysicsStep,
+	PhysicsResponse,
+	RenderSync,
+	Draw,
+	Frame,
+	Count
+};
+
+/**
+ * @brief Physics step counters that are reported by the benchmark next to the phase times.
+*/
+enum class BenchmarkCounter
+{
+	ActiveBodies,
+	SleepingBodies,
+	BroadphasePairs,
+	Manifolds,
+	ContactPoints,
+	SolverIterations,
+	Islands,
+	Count
+};
+
+/**
+ * @brief Collects the phase times of every frame and reports their statistics.
+*/
+class Benchmark
+{
+private:
+	using json = nlohmann::json;
+
+	static constexpr size_t PhaseCount = (size_t)BenchmarkPhase::Count;
+	static constexpr size_t CounterCount = (size_t)BenchmarkCounter::Count;
+
+	/**
+	 * @brief Flag for measuring the phases.
+	*/
+	bool mActive = false;
+
+	/**
+	 * @brief Amount of frames to skip before the samples are collected.
+	*/
+	unsigned int mWarmupFrames = 0;
+
+	/**
+	 * @brief Amount of finished frames, including the warm-up.
+	*/
+	unsigned int mFrameCount = 0;
+
+	/**
+	 * @brief Flag for a started frame whose phase times have not been stored yet.
+	*/
+	bool mFrameOpen = false;
+
+	/**
+	 * @brief Phase times of the current frame in nanoseconds. Atomic as the sync tasks run on the worker threads.
+	*/
+	std::array<std::atomic<long long>, PhaseCount> mCurrentFrame{};
+
+	/**
+	 * @brief Phase times of every measured frame in milliseconds.
+	*/
+	std::array<std::vector<float>, PhaseCount> mSamples;
+
+	/**
+	 * @brief Highest counter values of the current frame, as a spike is what slows the frame down.
+	*/
+	std::array<unsigned int, CounterCount> mCurrentCounters{};
+
+	/**
+	 * @brief Flag for a frame that had a physics step, frames without one do not have counter samples.
+	*/
+	bool mCountersSet = false;
+
+	/**
+	 * @brief Counter values of every measured frame that had a physics step.
+	*/
+	std::array<std::vector<unsigned int>, CounterCount> mCounterSamples;
+
+	/**
+	 * @brief Get the statistics of every phase.
+	*/
+	json GetResults() const;
+
+	/**
+	 * @brief Compare the results against the baseline.
+	 * @return Found regressions, empty if there are none.
+	*/
+	json FindRegressions(json const& results, json const& baseline, RegressionThresholds const& thresholds) const;
+
+	/**
+	 * @brief Store the phase times of the current frame.
+	*/
+	void StoreFrame();
+public:
+	/**
+	 * @brief Get the name of the phase as it is written in the results.
+	*/
+	static char const* GetPhaseName(BenchmarkPhase const phase);
+
+	/**
+	 * @brief Get the name of the counter as it is written in the results.
+	*/
+	static char const* GetCounterName(BenchmarkCounter const counter);
+
+	/**
+	 * @brief Start collecting the samples.
+	 * @param warmupFrames Amount of frames at the start that are not measured.
+	*/
+	void Start(unsigned int const warmupFrames);
+
+	/**
+	 * @brief Check if the benchmark is collecting the samples.
+	*/
+	inline bool IsActive() const noexcept
+	{
+		return mActive;
+	}
+
+	/**
+	 * @brief Add time to a phase of the current frame.
+	 * @param phase
+	 * @param nanoseconds
+	*/
+	inline void AddTime(BenchmarkPhase const phase, long long const nanoseconds) noexcept
+	{
+		mCurrentFrame[(size_t)phase].fetch_add(nanoseconds, std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Set the value of a counter in the current frame, keeping the highest one of the frame.
+	 * @note Only called from the main thread.
+	 * @param counter
+	 * @param value
+	*/
+	inline void SetCounter(BenchmarkCounter const counter, unsigned int const value) noexcept
+	{
+		auto& current = mCurrentCounters[(size_t)counter];
+		current = mCountersSet ? std::max(current, value) : value;
+	}
+
+	/**
+	 * @brief Mark the counters of the current frame as set, once all of them are.
+	*/
+	inline void CountersSet() noexcept
+	{
+		mCountersSet = true;
+	}
+
+	/**
+	 * @brief Start a new frame, storing the phase times of the previous one.
+	 * @note Has to be called before any of the frame's zones are created, so that they all end up in the same frame.
+	*/
+	void BeginFrame();
+
+	/**
+	 * @brief Store the phase times of the last frame.
+	*/
+	void EndFrames();
+
+	/**
+	 * @brief Save the results and compare them against the baseline.
+	 * @param settings Paths and thresholds of the benchmark.
+	 * @return False if a regression was found or the baseline could not be read.
+	*/
+	bool Report(RunSettings const& settings) const;
+};
+
+/**
+ * @brief Measures the time from its creation until it goes out of scope and adds it to the phase.
+*/
+class BenchmarkZone
+{
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	Benchmark& mBenchmark;
+	BenchmarkPhase mPhase;
+	Clock::time_point mStart;
+public:
+	BenchmarkZone(Benchmark& benchmark, BenchmarkPhase const phase) : mBenchmark(benchmark), mPhase(phase)
+	{
+		if (mBenchmark.IsActive())
+			mStart = Clock::now();
+	}
+
+	BenchmarkZone(BenchmarkZone const&) = delete;
+	BenchmarkZone& operator=(BenchmarkZone const&) = delete;
+
+	~BenchmarkZone()
+	{
+		if (mBenchmark.IsActive())
+			mBenchmark.AddTime(mPhase, std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - mStart).count());
+	}
+};
+#endif // GAME
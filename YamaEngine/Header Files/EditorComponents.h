@@ -155,9 +155,9 @@ class PhysicsEditorComponent : public EditorComponentBase
 public:
 	/**
 	 * @brief Collider type.
-	 * @note Currently only "Box" is supported.
+	 * @note One of "Box", "Sphere", "Capsule", "ConvexHull", "Compound" or "TriangleMesh".
 	*/
-	std::string mColliderType = "Box"; // Might have to replace by an enum, though as this is the only supported type right now it is not worth the hassle to setup a list-box within the menu.
+	std::string mColliderType = "Box"; // Might have to replace by an enum and a list-box within the menu.
 
 	/**
 	 * @brief Mass of the object that will determine it's movements and collisions with other objects.
@@ -170,10 +170,57 @@ public:
 	*/
 	yamath::Vec3D mExtents{ 0, 0, 0 };
 
+	/**
+	 * @brief Radius of the sphere and capsule colliders.
+	*/
+	float mRadius = 0.f;
+
+	/**
+	 * @brief Height of the capsule collider, without the caps.
+	*/
+	float mHeight = 0.f;
+
+	/**
+	 * @brief Mesh of the convex hull and triangle mesh colliders.
+	*/
+	std::string mMeshPath = "";
+
+	/**
+	 * @brief Scale of the convex hull and triangle mesh colliders.
+	*/
+	yamath::Vec3D mScale{ 1, 1, 1 };
+
+	/**
+	 * @brief Children of the compound collider.
+	 * @note Not editable in the menu, only kept so that saving the scene does not lose them.
+	*/
+	nlohmann::json mChildren;
+
 	/**
 	 * @brief Offset from the center which is the position of the transform component.
 	*/
 	yamath::Vec3D mOffsets{ 0, 0, 0 };
+
+	/**
+	 * @brief Name of the collision layer from the main configuration file.
+	 * @note Left empty the layer is picked by the mass.
+	*/
+	std::string mLayer = "";
+
+	/**
+	 * @brief Flag for a trigger collider, which only reports overlaps and ignores the mass.
+	*/
+	bool mTrigger = false;
+
+	/**
+	 * @brief Flag for a body that is moved by the scripts instead of the physics engine. The mass is ignored.
+	*/
+	bool mKinematic = false;
+
+	/**
+	 * @brief Flag for a static collider that can be merged with the other static colliders of its layer when the scene is loaded.
+	*/
+	bool mMerge = true;
 public:
 	PhysicsEditorComponent();
 	nlohmann::json GetJsonedObject() override;
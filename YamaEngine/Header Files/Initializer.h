@@ -8,10 +8,14 @@ import <string_view>;
 import Logger;
 import <vector>;
 import <optional>;
+import <algorithm>;
+import <unordered_map>;
 import Component.Transform;
 import Graphics;
 import SceneObject;
 import Component.GameLogic;
+import RunSettings;
+import GameTime;
 
 #ifdef GAME
 import AudioWrapper;
@@ -42,14 +46,43 @@ private:
 	* @note Is loaded once on startup and then not modified.
 	*/
 	std::vector<SceneObject> mAvailableScene;
+
+	/**
+	 * @brief Static collider that is waiting to be merged with the others of its layer.
+	*/
+	struct PendingStaticCollider
+	{
+		entt::entity mEntity;
+		ShapeDescription mShape;
+		yamath::Vec3D mOffset;
+		int mLayer;
+	};
+
+	/**
+	 * @brief Static colliders of the scene that is being populated.
+	 * @note Only filled while the registry is being populated.
+	*/
+	std::vector<PendingStaticCollider> mPendingStatics;
 #endif // GAME
 
 	/**
 	 * @brief Current scene ID.
 	*/
 	int mCurrentScene;
+
+	/**
+	 * @brief Time settings of the current scene, which are the main configuration defaults with the scene overrides applied.
+	*/
+	TimeSettings mSceneTimeSettings;
 private:
 
+	/**
+	 * @brief Override the time settings with the values that are present in the JSON object.
+	 * @param settings Settings to be overridden.
+	 * @param timeJson JSON data about the time settings. Missing keys keep the current values.
+	*/
+	void ReadTimeSettings(TimeSettings& settings, json const& timeJson);
+
 	/**
 	 * @brief Add a transform component to the entity registry and apply it to the provided entity.
 	 * @param registry Game scene registry.
@@ -82,6 +115,21 @@ private:
 	*/
 	void PopulateWithPhysics(entt::registry& registry, entt::entity& entity, json const& physicsComponentJson);
 
+	/**
+	 * @brief Read the collider shape, including the children of a compound.
+	 * @param shapeJson JSON data with the collider type and its parameters.
+	 * @param shape Filled with the read data.
+	 * @return False if the shape is not valid. Invalid compound children are skipped instead.
+	*/
+	bool ReadShapeDescription(json const& shapeJson, ShapeDescription& shape);
+
+	/**
+	 * @brief Merge the pending static colliders of each collision layer into a single compound body, placed on a new entity.
+	 * @note Contacts are still reported with the entities of the merged colliders, but the bodies no longer follow their transforms.
+	 * @param registry Game scene registry.
+	*/
+	void MergeStaticColliders(entt::registry& registry);
+
 	/**
 	 * @brief Add a script manager component to the entity registry and apply it to the provided entity.
 	 * @param registry Game scene registry.
@@ -152,6 +200,24 @@ public:
 	*/
 	std::pair<unsigned int, unsigned int> GetResolution();
 
+	/**
+	 * @brief Get the run settings (headless mode, limits, starting scene) from the main configuration file.
+	 * @return Default settings if the configuration file does not contain them.
+	*/
+	RunSettings GetRunSettings();
+
+	/**
+	 * @brief Get the amount of job system worker threads from the main configuration file.
+	 * @return Negative value if the amount should be picked based on the hardware.
+	*/
+	int GetWorkerThreadCount();
+
+	/**
+	 * @brief Get the default time settings (fixed step, sub-step cap, time scale and frame limiter) from the main configuration file.
+	 * @return Default settings if the configuration file does not contain them.
+	*/
+	TimeSettings GetTimeSettings();
+
 	/**
 	 * @brief Load the logging files from the main configuration file.
 	*/
@@ -170,6 +236,25 @@ public:
 	*/
 	void LoadScenesConfigs();
 
+	/**
+	 * @brief Get the collision layers and the layer matrix from the main configuration file.
+	 * @note A pair collides if either of the layers lists the other one.
+	 * @return Empty if the configuration file does not contain them.
+	*/
+	std::vector<CollisionLayer> GetCollisionLayers();
+
+	/**
+	 * @brief Bake the BVH of every triangle mesh collider used by the scenes, so that they are not built when the scenes are loaded.
+	 * @return False if any of them could not be baked.
+	*/
+	bool BakeColliders();
+
+	/**
+	 * @brief Get the amount of threads for the physics simulation from the main configuration file.
+	 * @return 1 (single threaded) if the configuration file does not contain it.
+	*/
+	int GetPhysicsThreadCount();
+
 	/**
 	 * @brief Load scene by its ID.
 	 * @param sceneId
@@ -186,6 +271,15 @@ public:
 		return mCurrentScene;
 	}
 
+	/**
+	 * @brief Get the time settings of the last loaded scene.
+	 * @return
+	*/
+	inline TimeSettings const& GetSceneTimeSettings()
+	{
+		return mSceneTimeSettings;
+	}
+
 	/**
 	 * @brief Get an ID of next scene.
 	 * @return If there is a scene whose ID is larger than the current one, the ID will be returned, otherwise - empty object.
@@ -0,0 +1,184 @@
+#ifdef GAME
+#pragma once
+#include "nlohmann/json.hpp"
+import <vector>;
+import <string>;
+import <fstream>;
+import <optional>;
+import Input;
+import Logger;
+
+// Recorded per fixed step rather than per frame, as the amount of steps in a frame depends on how fast the machine is.
+// Consecutive steps with the same input are stored as a single run, since the input rarely changes from one step to the other.
+
+/**
+ * @brief Everything that is needed to repeat a session.
+*/
+struct ReplayData
+{
+	/**
+	 * @brief Seed for the random number generation.
+	*/
+	unsigned int mSeed = 0;
+
+	/**
+	 * @brief ID of the scene that the session started in.
+	*/
+	int mStartScene = 1;
+
+	/**
+	 * @brief Fixed step of the starting scene when it was recorded.
+	*/
+	float mFixedStep = 0;
+
+	/**
+	 * @brief Total amount of the recorded fixed steps.
+	*/
+	unsigned long long mStepCount = 0;
+
+	/**
+	 * @brief Input state that lasted for a number of steps.
+	*/
+	struct InputRun
+	{
+		Input::InputState mState;
+		unsigned int mCount = 0;
+	};
+
+	/**
+	 * @brief Input of every step.
+	*/
+	std::vector<InputRun> mInputRuns;
+
+	/**
+	 * @brief Scene changes as [step before which the scene was changed, scene ID].
+	*/
+	std::vector<std::pair<unsigned long long, int>> mSceneChanges;
+};
+
+/**
+ * @brief Records the input and scene changes of a session.
+*/
+class ReplayRecorder
+{
+private:
+	using json = nlohmann::json;
+
+	/**
+	 * @brief The recorded session.
+	*/
+	ReplayData mData;
+public:
+	/**
+	 * @brief Start a new recording.
+	 * @param seed Seed for the random number generation.
+	 * @param startScene ID of the first scene.
+	 * @param fixedStep Fixed step of the first scene.
+	*/
+	void Begin(unsigned int const seed, int const startScene, float const fixedStep);
+
+	/**
+	 * @brief Record the input of a fixed step.
+	 * @param state
+	*/
+	void RecordStep(Input::InputState const& state);
+
+	/**
+	 * @brief Record a scene change before the next fixed step.
+	 * @param sceneId
+	*/
+	void RecordSceneChange(int const sceneId);
+
+	/**
+	 * @brief Save the recording as a JSON file.
+	 * @param path
+	*/
+	void Save(std::string const& path) const;
+};
+
+/**
+ * @brief Plays back a recorded session.
+*/
+class ReplayPlayer
+{
+private:
+	using json = nlohmann::json;
+
+	/**
+	 * @brief The played session.
+	*/
+	ReplayData mData;
+
+	/**
+	 * @brief Index of the current input run.
+	*/
+	size_t mRunIndex = 0;
+
+	/**
+	 * @brief Amount of steps played from the current input run.
+	*/
+	unsigned int mRunStep = 0;
+
+	/**
+	 * @brief Amount of played steps.
+	*/
+	unsigned long long mStep = 0;
+
+	/**
+	 * @brief Index of the next scene change.
+	*/
+	size_t mSceneChangeIndex = 0;
+public:
+	/**
+	 * @brief Load the recording from a JSON file.
+	 * @param path
+	 * @return False if the recording could not be loaded.
+	*/
+	bool Load(std::string const& path);
+
+	/**
+	 * @brief Get the seed for the random number generation.
+	*/
+	inline unsigned int GetSeed() const noexcept
+	{
+		return mData.mSeed;
+	}
+
+	/**
+	 * @brief Get the ID of the first scene.
+	*/
+	inline int GetStartScene() const noexcept
+	{
+		return mData.mStartScene;
+	}
+
+	/**
+	 * @brief Get the fixed step that the first scene was recorded with.
+	*/
+	inline float GetFixedStep() const noexcept
+	{
+		return mData.mFixedStep;
+	}
+
+	/**
+	 * @brief Get the input of the next fixed step.
+	 * @param state
+	 * @return False if the recording has ended.
+	*/
+	bool NextStep(Input::InputState& state);
+
+	/**
+	 * @brief Get the scene change that has to happen before the next fixed step.
+	 * @return Empty if there is none.
+	*/
+	std::optional<int> PopSceneChange();
+
+	/**
+	 * @brief Check if every recorded step was played.
+	*/
+	inline bool IsFinished() const noexcept
+	{
+		return mStep >= mData.mStepCount;
+	}
+};
+#endif // GAME
@@ -19,7 +19,7 @@ private:
 private:
 public:
 public:
-	[[nodiscard]] inline YmEventReturn Start(float deltaTime, entt::registry& registry, entt::entity const& thisEntity) override
+	inline void Start(float deltaTime, entt::registry& registry, entt::entity const& thisEntity, EventWriter& events) override
 	{
 		auto* navigation = registry.try_get<BeaconNavigation>(thisEntity);
 		if (navigation)
@@ -30,13 +30,12 @@ public:
 		{
 			Log(LGR_WARNING, "The beacon navigation component was not found on an entity that is trying to use AI Walker script.");
 		}
-		return {};
 	}
 
 
-	[[nodiscard]] inline YmEventReturn Update(float deltaTime, entt::registry& registry, entt::entity const& thisEntity) override
+	inline void Update(float deltaTime, entt::registry& registry, entt::entity const& thisEntity, EventWriter& events) override
 	{
-		auto& transform = registry.get<Transform>(thisEntity);
+		auto const& transform = registry.get<Transform>(thisEntity);
 
 		auto distance = yamath::opr::Sub(mCurrentTarget, transform.mPosition);
 
@@ -56,9 +55,8 @@ public:
 		else
 		{
 			auto dir = yamath::opr::Normalize(distance);
-			transform.mPosition = yamath::opr::Add(transform.mPosition, yamath::opr::Mult(dir, 3 * deltaTime));
+			Transform::Translate(registry, thisEntity, yamath::opr::Mult(dir, 3 * deltaTime));
 		}
-		return {};
 	}
 };
 #endif // GAME
\ No newline at end of file
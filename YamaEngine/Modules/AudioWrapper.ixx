@@ -31,10 +31,14 @@ namespace Audio
 
 	/**
 	 * @brief Initialize the audio player.
+	 * @param silent Use a null back-end, so that sounds are mixed, but no audio device is needed.
 	*/
-	export inline void Init()
+	export inline void Init(bool const silent = false)
 	{
-		soloud.init();
+		if (silent)
+			soloud.init(SoLoud::Soloud::CLIP_ROUNDOFF, SoLoud::Soloud::NULLDRIVER);
+		else
+			soloud.init();
 	}
 
 	/**
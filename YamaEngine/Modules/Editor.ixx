@@ -29,20 +29,21 @@ private:
 public:
 
 	/**
-	 * @brief Populate the transform component from its editor counterpart.
+	 * @brief Populate the transform and identity components from their editor counterpart.
 	 * @param transform
+	 * @param identity
 	 * @param transformEditorComponent
 	*/
-	void PopulateTransform(Transform& transform, TransformEditorComponent& transformEditorComponent)
+	void PopulateTransform(Transform& transform, Identity& identity, TransformEditorComponent& transformEditorComponent)
 	{
 		auto& values = transformEditorComponent;
 		transform.mPosition = values.mPos;
 
-		transform.mRotation = values.mRot;
+		transform.mRotation = yamath::opr::FromEuler(values.mRot);
 
 		transform.mScale = values.mScale;
-		transform.mName = values.mName;
-		transform.mTag = values.mTag;
+		identity.mName = values.mName;
+		identity.mTag = values.mTag;
 	}
 
 	/**
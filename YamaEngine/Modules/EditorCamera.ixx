@@ -26,11 +26,15 @@ private:
 	 * @brief Current time for the control state switch cool-down.
 	*/
 	float mCurrentTime = 0;
+
+	/**
+	 * @brief Euler angles of the camera in degrees.
+	 * @note Kept apart from the quaternion in the transform, so that the pitch can be clamped.
+	*/
+	yamath::Vec3D mAngles{ 0, 0, 0 };
 public:
-	[[nodiscard]] inline YmEventReturn Update(float deltaTime, entt::registry& registry, entt::entity const& thisEntity) override
+	inline void Update(float deltaTime, entt::registry& registry, entt::entity const& thisEntity, EventWriter& events) override
 	{
-		YmEventList eventList;
-
 		bool firstUpdateAfterLock = false; // To prevent that awful jump when switching the states.
 
 		if (mCurrentTime >= mTimeBeforeNextSwitch)
@@ -43,11 +47,11 @@ public:
 				if (mControlState)
 				{
 					firstUpdateAfterLock = true;
-					eventList.emplace_back(YmEventTypes::CursorState, new int(CursorStates::CursorInvisible | CursorStates::CurosrLocked));
+					events.Emit(CursorStateEvent{ CursorStates::CursorInvisible | CursorStates::CurosrLocked });
 				}
 				else
 				{
-					eventList.emplace_back(YmEventTypes::CursorState, new int(0));
+					events.Emit(CursorStateEvent{ 0 });
 				}
 			}
 		}
@@ -101,34 +105,32 @@ public:
 				auto [mouseXRel, mouseYRel] = Input::GetMousePositionRel();
 				if (mouseXRel != 0 || mouseYRel != 0)
 				{
-					transform.mRotation.Y += mouseXRel * deltaTime * 10000;
-					transform.mRotation.X += mouseYRel * deltaTime * 10000;
+					mAngles.Y += mouseXRel * deltaTime * 10000;
+					mAngles.X += mouseYRel * deltaTime * 10000;
 
-					if (transform.mRotation.Y >= 360 || transform.mRotation.Y <= -360)
+					if (mAngles.Y >= 360 || mAngles.Y <= -360)
 					{
-						transform.mRotation.Y = 0;
+						mAngles.Y = 0;
 					}
 
-					if (transform.mRotation.X >= 80)
+					if (mAngles.X >= 80)
 					{
-						transform.mRotation.X = 80;
+						mAngles.X = 80;
 					}
-					else if (transform.mRotation.X <= -80)
+					else if (mAngles.X <= -80)
 					{
-						transform.mRotation.X = -80;
+						mAngles.X = -80;
 					}
+
+					transform.mRotation = yamath::opr::FromEuler(mAngles);
 				}
 			}
 		}
-		if (eventList.size() > 0)
-			return eventList;
-		return {};
 	}
 
-	[[nodiscard]] inline YmEventReturn DrawItems() override
+	inline void DrawItems(EventWriter& events) override
 	{
 		GUI::Instance().CameraControlState(mControlState);
-		return {};
 	};
 };
 #endif // EDITOR
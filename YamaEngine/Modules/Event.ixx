@@ -1,33 +1,23 @@
+module;
+#include "entity/registry.hpp"
 export module YamaEvents;
 export import <optional>;
-export import <list>;
 export import <variant>;
+import <vector>;
+import <array>;
+import <functional>;
+import <type_traits>;
+import <string>;
 import Logger;
 
-// Could be replaced by eventpp if something more complex is needed
-
-// The entire event queue could be global object as it would save time returning and merging the items, however due to the notes about how to treat game scripts it should probably be better to return them and then merge them, as otherwise scripts could modify the event list in an unexpected way.
-// The event modification could be prevented by making this a friend class of the engine, but unlike graphics and physics there are no real reasons to avoid it right now.
-
-/**
- * @brief Engine event types.
-*/
-export enum YmEventTypes
-{
-	Unassigned,
-	DeleteEntity,
-	ExitApplication,
-	CursorState,
-#ifdef GAME
-	ChangeScene,
-#endif // GAME
-
 #ifdef EDITOR
-	EditorChange,
-	SceneFileLoad,
+import "EditorComponents.h";
 #endif // EDITOR
-	EventTypeCount
-};
+
+// Could be replaced by eventpp if something more complex is needed
+
+// Scripts used to return their own event lists which were then merged upwards, but building and splicing the lists on every call cost more than the events themselves.
+// Now they receive an EventWriter instead, which can only append to the engine's queue, so the scripts still cannot modify or handle the events of others.
 
 #ifdef GAME
 
@@ -45,84 +35,243 @@ export enum YmEventTypes
 export typedef std::variant<int, std::pair<int, bool>> SceneChangeMessage;
 #endif // GAME
 
+// The payloads are stored inside of the event itself, so creating an event does not allocate anything, unlike the old void* data that had to be new'ed and deleted by the handler.
+
+/**
+ * @brief Remove the entity from the registry.
+*/
+export struct DeleteEntityEvent
+{
+	entt::entity mEntity = entt::null;
+};
+
+/**
+ * @brief Close the application.
+*/
+export struct ExitApplicationEvent
+{
+};
+
+/**
+ * @brief Change the visibility and the lock of the cursor.
+*/
+export struct CursorStateEvent
+{
+	/**
+	 * @brief Combination of CursorStates flags.
+	*/
+	int mFlags = 0;
+};
+
+#ifdef GAME
+/**
+ * @brief Load a different scene.
+*/
+export struct ChangeSceneEvent
+{
+	SceneChangeMessage mMessage;
+};
+
+/**
+ * @brief Put the physics bodies of the scene back to the state they had after it was loaded, without reloading the scene.
+ * @note Only the bodies and their entities' transforms are restored, the deleted entities and the script states stay as they are.
+*/
+export struct RestorePhysicsEvent
+{
+};
+#endif // GAME
+
+#ifdef EDITOR
+/**
+ * @brief Add or remove an editor component.
+*/
+export struct EditorChangeEvent
+{
+	entt::entity mEntity = entt::null;
+	EditorComponentTypes mComponentType = EditorTransformType;
+
+	/**
+	 * @brief True to add, false to delete.
+	*/
+	bool mAdd = true;
+};
+
+/**
+ * @brief Load a scene file into the editor.
+ * @note Only happens when the user picks a file, so the string allocation does not matter.
+*/
+export struct SceneFileLoadEvent
+{
+	std::string mPath;
+};
+#endif // EDITOR
+
 /**
  * @brief Structure for an event.
- * @note Use to make system wide changes from anywhere in the code.
+ * @note Use to make system wide changes from anywhere in the code. The alternative index is the event type.
 */
-export struct YmEvent
+export typedef std::variant<DeleteEntityEvent, ExitApplicationEvent, CursorStateEvent
+#ifdef GAME
+	, ChangeSceneEvent, RestorePhysicsEvent
+#endif // GAME
+#ifdef EDITOR
+	, EditorChangeEvent, SceneFileLoadEvent
+#endif // EDITOR
+	> YmEvent;
+
+/**
+ * @brief Get the index of the event type within the YmEvent variant.
+*/
+template<typename Event, typename... Events>
+constexpr size_t EventIndex(std::variant<Events...> const*)
 {
+	static_assert((std::is_same_v<Event, Events> || ...), "Type is not a part of YmEvent");
+
+	size_t index = 0;
+	bool found = false;
+	((found = found || std::is_same_v<Event, Events>, index += found ? 0 : 1), ...);
+	return index;
+}
+
+/**
+ * @brief Index of the event type within the YmEvent variant.
+*/
+export template<typename Event>
+constexpr size_t EventTypeId = EventIndex<Event>((YmEvent const*)nullptr);
+
+/**
+ * @brief Queues the events and passes them to the handlers registered for their type.
+ * @note The queue is a ring buffer that only grows if more events are queued at once than ever before, so in a steady state emitting and dispatching does not allocate.
+ * Not thread safe, the events are emitted either by the game step or by the main thread, which waits for the game step to finish.
+*/
+export class EventBus
+{
+private:
 	/**
-	 * @brief Stored event type.
-	 * @note Used to predict what kind of data is stored within in.
+	 * @brief Amount of event types.
 	*/
-	YmEventTypes mType;
+	static constexpr size_t TypeCount = std::variant_size_v<YmEvent>;
 
-	// Wanted to use std::any, but it appears that the performance is affected and the types are usually known. In addition shared_ptr adds too much overhead :'/
-	//https://devblogs.microsoft.com/cppblog/stdany-how-when-and-why/
+	/**
+	 * @brief Queued events, used as a ring buffer.
+	*/
+	std::vector<YmEvent> mQueue;
 
 	/**
-	 * @brief The event data/message.
+	 * @brief Index of the oldest queued event.
 	*/
-	void* mData;
+	size_t mHead = 0;
 
-	YmEvent() = default;
-	YmEvent(YmEventTypes const& type, void* data) : mType(type), mData(data) {}
-	~YmEvent()
-	{
-		if (mData)
-			Log(LGR_WARNING, std::format("The data withing event of type {}, has not been deleted before the destruction of the event this can potentially cause a memory leak.", (int)mType));
-	};
+	/**
+	 * @brief Amount of queued events.
+	*/
+	size_t mCount = 0;
 
-	// Copy operators are kept in as the destructor check should point out any issues.
-	// Need to redeclare the move functionality due to the declaration of the destructor.
+	/**
+	 * @brief Handlers of every event type.
+	*/
+	std::array<std::vector<std::function<void(YmEvent&)>>, TypeCount> mHandlers;
 
-	// Move is highly preferred over copy as mainly due to the speed and the destructor check.
+	/**
+	 * @brief Double the queue, keeping the order of the events.
+	*/
+	inline void Grow()
+	{
+		std::vector<YmEvent> queue(mQueue.size() * 2);
+		for (size_t i = 0; i < mCount; i++)
+			queue[i] = std::move(mQueue[(mHead + i) % mQueue.size()]);
 
-	YmEvent(YmEvent&& move) noexcept
+		mQueue = std::move(queue);
+		mHead = 0;
+	}
+public:
+	/**
+	 * @param capacity Amount of events that fit in before the queue has to grow.
+	*/
+	explicit EventBus(size_t const capacity = 64) : mQueue(capacity > 0 ? capacity : 1)
 	{
-		mType = std::move(move.mType);
-		move.mType = Unassigned;
+	}
 
-		mData = std::move(move.mData);
-		move.mData = nullptr;
+	/**
+	 * @brief Register a handler for the event type.
+	 * @note Handlers are called in the order they were registered.
+	 * @param handler Callable taking Event&.
+	*/
+	template<typename Event, typename Handler>
+	inline void Subscribe(Handler&& handler)
+	{
+		mHandlers[EventTypeId<Event>].emplace_back([handler = std::forward<Handler>(handler)](YmEvent& event) { handler(*std::get_if<Event>(&event)); });
 	}
-	YmEvent& operator=(YmEvent&& move) noexcept
+
+	/**
+	 * @brief Queue an event.
+	 * @param event
+	*/
+	inline void Emit(YmEvent&& event)
 	{
-		std::swap(mType, move.mType);
-		std::swap(mData, move.mData);
-		return *this;
+		if (mCount == mQueue.size())
+			Grow();
+
+		mQueue[(mHead + mCount) % mQueue.size()] = std::move(event);
+		mCount++;
 	}
-};
 
-// Chose List because insert and remove head/tail are o(1) and should be cheap to merge
+	/**
+	 * @brief Pass the queued events to their handlers.
+	 * @note Events emitted by the handlers are left for the next dispatch, so that a handler cannot keep the dispatch going forever.
+	*/
+	inline void Dispatch()
+	{
+		for (auto pending = mCount; pending > 0; pending--)
+		{
+			// Moved out, as the handlers can emit new events which might grow the queue.
+			auto event = std::move(mQueue[mHead]);
+			mHead = (mHead + 1) % mQueue.size();
+			mCount--;
 
-/**
- * @brief List of events.
- * @note Use a storage in a function and then return it.
-*/
-export typedef std::list<YmEvent> YmEventList;
+			auto& handlers = mHandlers[event.index()];
+			if (handlers.empty())
+				Log(LGR_ERROR, std::format("Did not handle an event of type {}", event.index()));
 
-/**
- * @brief Return type. Useful for when to events happened.
-*/
-export typedef std::optional<YmEventList> YmEventReturn;
+			for (auto& handler : handlers)
+				handler(event);
+		}
+	}
+
+	/**
+	 * @brief Drop all of the queued events without handling them.
+	*/
+	inline void Clear() noexcept
+	{
+		mHead = 0;
+		mCount = 0;
+	}
+};
 
 /**
- * @brief Merges contents of list b into the list a without sorting.
- * Doesn't copy, just moves the items.
- * Should be used over the std::list::merge() because of the lack of the comparisons.
- * @param a
- * @param b
- * @return
+ * @brief Write only access to the event queue, given to the game scripts and the GUI.
 */
-export inline void MergeYmEventLists(YmEventList& a, YmEventList & b)
+export class EventWriter
 {
-	while (b.size() > 0)
+private:
+	/**
+	 * @brief Queue that the events are written into.
+	*/
+	EventBus& mBus;
+public:
+	explicit EventWriter(EventBus& bus) : mBus(bus)
 	{
-		a.emplace_back(std::move(b.front()));
-		b.pop_front();
 	}
-}
+
+	/**
+	 * @brief Queue an event, e.g. Emit(ChangeSceneEvent{ 1 }).
+	 * @param event
+	*/
+	inline void Emit(YmEvent&& event)
+	{
+		mBus.Emit(std::move(event));
+	}
+};
 
 /**
  * @brief Flags for different cursor states.
@@ -4,10 +4,11 @@ module;
 #include "entity/observer.hpp"
 export module GameEngine;
 import <chrono>;
-import <unordered_map>;
 import "Initializer.h";
 import <memory>;
 import <deque>;
+import <limits>;
+import <algorithm>;
 import Graphics;
 import Logger;
 import Component.Transform;
@@ -16,10 +17,19 @@ import GUIWrapper;
 import YamaEvents;
 import Component.GameLogic;
 import DataVault;
+import RunSettings;
+import JobSystem;
+import TaskGraph;
+import GameTime;
+import ProfilingZones;
 
 #ifdef GAME
 import PhysicsWrapper;
 import AudioWrapper;
+import "Replay.h";
+import "Benchmark.h";
+import <random>;
+import <cstdlib>;
 #endif // GAME
 
 #ifdef PROFILING
@@ -34,12 +44,124 @@ using std::vector;
 */
 constexpr auto PathToConfigFile = "yamaConfig.json";
 
-// Also works in 240, but just in case set it to 120 as it seems to be a healthy amount.
+#ifdef GAME
+/**
+ * @brief Frame timing collected while running headless.
+*/
+struct RunSummary
+{
+	/**
+	 * @brief Number of frames that were run.
+	*/
+	unsigned int mFrames = 0;
+
+	/**
+	 * @brief Real time spent on all of the frames.
+	*/
+	float mTotalTime = 0;
+
+	/**
+	 * @brief Game time that was simulated.
+	*/
+	float mSimulatedTime = 0;
+
+	/**
+	 * @brief The quickest frame.
+	*/
+	float mShortestFrame = std::numeric_limits<float>::max();
+
+	/**
+	 * @brief The slowest frame.
+	*/
+	float mLongestFrame = 0;
+
+	/**
+	 * @brief Time point at which the run was started.
+	*/
+	std::chrono::steady_clock::time_point mStart = std::chrono::steady_clock::now();
+
+	/**
+	 * @brief Add a frame to the summary.
+	 * @param frameTime Real time the frame took in seconds.
+	 * @param simulatedTime Game time the frame has advanced in seconds.
+	*/
+	inline void AddFrame(float const frameTime, float const simulatedTime) noexcept
+	{
+		mFrames++;
+		mTotalTime += frameTime;
+		mSimulatedTime += simulatedTime;
+		mShortestFrame = std::min(mShortestFrame, frameTime);
+		mLongestFrame = std::max(mLongestFrame, frameTime);
+	}
+
+	/**
+	 * @brief Get the real time passed since the start of the run.
+	*/
+	inline float SecondsSinceStart() const noexcept
+	{
+		std::chrono::duration<float> elapsedTime = std::chrono::steady_clock::now() - mStart;
+		return elapsedTime.count();
+	}
+
+	/**
+	 * @brief Log the timing summary.
+	*/
+	inline void LogSummary() const
+	{
+		if (mFrames == 0)
+		{
+			Log(LGR_WARNING, "Headless run has finished without running a single frame");
+			return;
+		}
+
+		auto meanFrame = mTotalTime / mFrames;
+		Log(LGR_INFO, std::format("Headless run finished. Frames: {}, simulated time: {}s, real time: {}s", mFrames, mSimulatedTime, SecondsSinceStart()));
+		Log(LGR_INFO, std::format("Frame time mean: {}ms, min: {}ms, max: {}ms, frames per second: {}", meanFrame * 1000, mShortestFrame * 1000, mLongestFrame * 1000, 1.f / meanFrame));
+	}
+};
 
 /**
- * @brief A fixed game and physics step.
+ * @brief Rotations of the synced entities, gathered so that they can be interpolated in a single batch.
+ * @note Kept between the frames, so the buffers are only allocated when the amount of moved entities grows.
 */
-constexpr float gameTimeStep = 1 / 120.f;
+struct RotationBatch
+{
+	/**
+	 * @brief Rotations before the latest fixed step.
+	*/
+	vector<yamath::Quat> mPrevious;
+
+	/**
+	 * @brief Current rotations.
+	*/
+	vector<yamath::Quat> mCurrent;
+
+	/**
+	 * @brief Interpolated rotations, in the same order as the observer.
+	*/
+	vector<yamath::Quat> mInterpolated;
+
+	/**
+	 * @brief Interpolate the rotations of the observed entities.
+	 * @param registry
+	 * @param observer Entities with both of the transforms.
+	 * @param alpha The interpolation state between the old transform and the new transform state
+	*/
+	inline void Interpolate(entt::registry const& registry, entt::observer const& observer, float const alpha)
+	{
+		mPrevious.clear();
+		mCurrent.clear();
+		for (auto const& entity : observer)
+		{
+			mPrevious.push_back(registry.get<PreviousTransform>(entity).mRotation);
+			mCurrent.push_back(registry.get<Transform>(entity).mRotation);
+		}
+
+		mInterpolated.resize(mCurrent.size());
+		yamath::opr::SlerpBatch(mCurrent.data(), mPrevious.data(), alpha, mInterpolated.data(), mInterpolated.size());
+	}
+};
+#endif // GAME
 
 /**
  * @brief A Game engine class containing all of the functionality needed to run Yama engine
@@ -67,8 +189,75 @@ private:
 	 * @brief Flag to check if a new scene should be loaded.
 	*/
 	bool mLoadNewScene = false;
+
+	/**
+	 * @brief Frame timing of the headless run.
+	*/
+	RunSummary mRunSummary;
+
+	/**
+	 * @brief Recorder of the session, if it was asked for.
+	*/
+	unique_ptr<ReplayRecorder> mRecorder;
+
+	/**
+	 * @brief Recording that drives the session, if it was asked for.
+	*/
+	unique_ptr<ReplayPlayer> mReplay;
+
+	/**
+	 * @brief Phase times of the benchmark run.
+	*/
+	Benchmark mBenchmark;
+
+	/**
+	 * @brief State of the physics bodies right after the scene was loaded and started.
+	*/
+	PhysicsSnapshot mSceneStartSnapshot;
+
+	// One per sync task, as they run at the same time.
+
+	/**
+	 * @brief Interpolated rotations of the moved meshes.
+	*/
+	RotationBatch mMeshRotations;
+
+	/**
+	 * @brief Interpolated rotations of the moved cameras.
+	*/
+	RotationBatch mCameraRotations;
+
+	/**
+	 * @brief Interpolated rotations of the moved lights.
+	*/
+	RotationBatch mLightRotations;
 #endif // GAME
 
+	/**
+	 * @brief Code returned by the process, non-zero if the benchmark found a regression.
+	*/
+	int mExitCode = 0;
+
+	/**
+	 * @brief Queue of the engine events.
+	*/
+	EventBus mEvents;
+
+	/**
+	 * @brief Write access to the event queue, passed to the game scripts.
+	*/
+	EventWriter mEventWriter{ mEvents };
+
+	/**
+	 * @brief How the engine is run, e.g. headless with a frame limit.
+	*/
+	RunSettings mRunSettings;
+
+	/**
+	 * @brief Game and real time keeper.
+	*/
+	GameTime mTime;
+
 	/**
 	 * @brief Initializer handler.
 	*/
@@ -106,9 +295,9 @@ private:
 	 * @brief Apply editor component changes onto the component registry.
 	 * @param modification
 	*/
-	void ApplyModifications(Modification& modification)
+	void ApplyModifications(EditorChangeEvent const& modification)
 	{
-		auto& [entity, componentType, add] = modification;
+		auto const& [entity, componentType, add] = modification;
 		switch (componentType)
 		{
 			using enum EditorComponentTypes;
@@ -118,6 +307,7 @@ private:
 				if (add)
 				{
 					mRegistry->emplace<Transform>(entity);
+					mRegistry->emplace<Identity>(entity);
 					mRegistry->emplace<TransformEditorComponent>(entity);
 				}
 				// Shouldn't be able to remove the transform component as then the entity would become orphaned + every entity (almost) needs it.
@@ -223,280 +413,305 @@ private:
 	}
 #endif // EDITOR
 
+#ifdef GAME
 	/**
-	 * @brief Handles the generated events.
-	 * @param events List of events to be handled.
+	 * @brief Load a scene and mark that the game loop has to start over.
+	 * @param sceneId
 	*/
-	inline void HandleEvents(YmEventList& events)
+	inline void LoadScene(int const sceneId)
 	{
-		// after deleting data needs to be set to zero, otherwise the destructor check will log it as data existance
-		while (events.size() > 0)
-		{
-			auto evnt = std::move(events.front());
-			events.pop_front();
+#ifdef PROFILING
+		mWatch.Start();
+#endif // PROFILING
 
-			switch (evnt.mType)
-			{
-				case DeleteEntity:
-				{
-					auto* entity = (int*)evnt.mData;
-					mRegistry->destroy((entt::entity)*entity);
-					delete entity;
-					evnt.mData = nullptr;
-					break;
-				}
+		mInit.LoadSceneById(sceneId, *mRegistry);
+		// Entity IDs of the new scene can match the ones from the old scene.
+		mPhysics->ClearContacts();
+		mRegistry->ctx<PhysicsQueries>().Clear();
+		// Shapes that the new scene shares with the old one were picked up from the cache, only the rest are freed.
+		mPhysics->ReleaseUnusedShapes();
 
-				case ExitApplication:
-				{
-					// Currently it's more like just a bool flag, so just having this is enough to indicate a change and no actual data is passed;
-					// If there are flags that behave like this it can be turned into a separate enum that will be stored in th mData;
-					mUserExit = true;
-					break;
-				}
+#ifdef PROFILING
+		auto time = mWatch.SecondsPassed();
+		Log(LGR_INFO, std::format("Time spent on loading {} scene : {}s", sceneId, time));
+#endif // PROFILING
 
-#ifdef GAME
-				case ChangeScene:
-				{
-					auto* message = (SceneChangeMessage*)evnt.mData;
-					int sceneId;
+		if (mRecorder)
+			mRecorder->RecordSceneChange(sceneId);
 
-					if(std::holds_alternative<int>(*message))
-						sceneId = std::get<int>(*message);
+		mLoadNewScene = true;
+	}
 
-					if (std::holds_alternative<std::pair<int, bool>>(*message))
-					{
-						auto[backUp, goNext] = std::get<std::pair<int, bool>>(*message);
-
-						sceneId = backUp;
-						if (goNext)
-						{
-							auto nextSceneID = mInit.GetNextSceneId();
-							if (nextSceneID.has_value())
-								sceneId = nextSceneID.value();
-						}
-					}
-#ifdef PROFILING
-					mWatch.Start();
-#endif // PROFILING
+	/**
+	 * @brief Set up the recording or the replay of the session, depending on the run settings.
+	 * @note Has to be called before the first scene is loaded, as the replay decides which scene it is.
+	 * @return Seed used for the random number generation.
+	*/
+	inline unsigned int InitReplay()
+	{
+		unsigned int seed = std::random_device()();
 
-					mInit.LoadSceneById(sceneId, *mRegistry);
+		if (!mRunSettings.mReplayPath.empty())
+		{
+			mReplay = std::make_unique<ReplayPlayer>();
+			if (mReplay->Load(mRunSettings.mReplayPath))
+			{
+				seed = mReplay->GetSeed();
+				mRunSettings.mStartScene = mReplay->GetStartScene();
+				mInput.SetReplaying(true);
+			}
+			else
+			{
+				mReplay.reset();
+			}
+		}
 
-#ifdef PROFILING
-					auto time = mWatch.SecondsPassed();
-					Log(LGR_INFO, std::format("Time spent on loading {} scene : {}s", sceneId, time));
-#endif // PROFILING
+		if (!mRunSettings.mRecordPath.empty())
+		{
+			if (mReplay)
+				Log(LGR_WARNING, "Cannot record a replayed session, recording will be skipped");
+			else
+				mRecorder = std::make_unique<ReplayRecorder>();
+		}
+
+		std::srand(seed);
+		DataVault["RandomSeed"] = seed;
+		return seed;
+	}
+#endif // GAME
 
+	/**
+	 * @brief Register the engine handlers of the events.
+	 * @note Called once, the handlers stay for all of the scenes.
+	*/
+	inline void RegisterEventHandlers()
+	{
+		mEvents.Subscribe<DeleteEntityEvent>([this](DeleteEntityEvent& event)
+											 {
+												 // Multiple collisions can ask for the same entity to be deleted within a step.
+												 if (!mRegistry->valid(event.mEntity))
+													 return;
 
-					delete message;
-					evnt.mData = nullptr;
-					mLoadNewScene = true;
-					break;
-				}
+#ifdef GAME
+												 // A static collider merged at load has no body of its own, it is a child of the merged body.
+												 mPhysics->RemoveMergedChild((int)event.mEntity);
 #endif // GAME
+												 mRegistry->destroy(event.mEntity);
+											 });
 
-				case CursorState:
-				{
-					auto* message = (int*)evnt.mData;
+		// Currently it's more like just a bool flag, so just having this is enough to indicate a change and no actual data is passed;
+		mEvents.Subscribe<ExitApplicationEvent>([this](ExitApplicationEvent&) { mUserExit = true; });
 
-					auto cursorVisibility = !(*message & CursorStates::CursorInvisible);
-					mInput.SetCursorVisible(cursorVisibility);
-					GUI::Instance().SetCursorState(cursorVisibility);
+#ifdef GAME
+		mEvents.Subscribe<ChangeSceneEvent>([this](ChangeSceneEvent& event)
+											{
+												// The recording decides when the scenes change, otherwise they would be changed twice.
+												if (mReplay)
+													return;
+
+												int sceneId;
+												auto const& message = event.mMessage;
+
+												if (std::holds_alternative<int>(message))
+													sceneId = std::get<int>(message);
+
+												if (std::holds_alternative<std::pair<int, bool>>(message))
+												{
+													auto [backUp, goNext] = std::get<std::pair<int, bool>>(message);
+
+													sceneId = backUp;
+													if (goNext)
+													{
+														auto nextSceneID = mInit.GetNextSceneId();
+														if (nextSceneID.has_value())
+															sceneId = nextSceneID.value();
+													}
+												}
+
+												LoadScene(sceneId);
+											});
 
-					auto cursorLockedState = (*message & CursorStates::CurosrLocked);
-					mInput.SetCursorLocked(cursorLockedState);
+		mEvents.Subscribe<RestorePhysicsEvent>([this](RestorePhysicsEvent&) { RestoreScenePhysics(); });
+#endif // GAME
 
-					delete message;
-					evnt.mData = nullptr;
-					break;
-				}
+		mEvents.Subscribe<CursorStateEvent>([this](CursorStateEvent& event)
+											{
+												auto cursorVisibility = !(event.mFlags & CursorStates::CursorInvisible);
+												mInput.SetCursorVisible(cursorVisibility);
+												if (!mRunSettings.mHeadless)
+													GUI::Instance().SetCursorState(cursorVisibility);
 
+												auto cursorLockedState = (event.mFlags & CursorStates::CurosrLocked);
+												mInput.SetCursorLocked(cursorLockedState);
+											});
 
 #ifdef EDITOR
-				case EditorChange:
-				{
-					auto* mod = (Modification*)evnt.mData;
-					ApplyModifications(*mod);
-					delete mod;
-					evnt.mData = nullptr;
-					break;
-				}
-
-				case SceneFileLoad:
-				{
-					auto* message = (std::string*)evnt.mData;
-					mInit.LoadSceneInEditor(*message, *mRegistry);
-					delete message;
-					evnt.mData = nullptr;
-					break;
-				}
+		mEvents.Subscribe<EditorChangeEvent>([this](EditorChangeEvent& event) { ApplyModifications(event); });
+		mEvents.Subscribe<SceneFileLoadEvent>([this](SceneFileLoadEvent& event) { mInit.LoadSceneInEditor(event.mPath, *mRegistry); });
 #endif // EDITOR
-
-				default:
-					Log(LGR_ERROR, std::format("Did not handle an event of type {}", (int)evnt.mType));
-					break;
-			}
-		}
 	}
 
+#ifdef EDITOR
 	/**
 	 * @brief Handles the updates for graphical nodes
-	 * @param alpha The interpolation state between the old transform and the new transform state
-	 * @param meshObserver Entities with mesh component whose transform was modified
-	 * @param cameraObserver Entities with camera component whose transform was modified
-	 * @param lightObserver Entities with light component whose transform was modified
-	 * @param oldTransforms Map of cached transforms from previous frame for smoother interpolation between physics updates.
 	*/
-	inline void RenderableObjectHandling(
-#ifdef GAME
-		float const& alpha
-		, entt::observer& meshObserver
-		, entt::observer& cameraObserver
-		, entt::observer& lightObserver
-		, std::unordered_map<entt::entity, Transform>& oldTransforms
-#endif // GAME
-	)
+	inline void RenderableObjectHandling()
 	{
-
-#ifdef GAME
-		for (auto const& entity : meshObserver)
-#else
 		// Observers can't be used right now as the editor values are changed in the GUI, meaning that in order to use the observer there would be a need to constantly check the values if they have changed.
 		for (auto&& [entity, transform, meshComp] : mRegistry->view<Transform, MeshComp>().each())
-#endif // EDITOR
 		{
-#ifdef GAME
-			auto& newState = mRegistry->get<Transform>(entity);
-			auto& meshComp = mRegistry->get<MeshComp>(entity);
-			auto oldState = oldTransforms[entity];
-			// Transfer the Transform data from the main component to the mesh data
-			mGraphics->UpdateMeshNode(oldState, newState, meshComp, alpha);
-#endif // GAME
-
-#ifdef EDITOR
-		// Since there is no lag calculation and the alpha would always return 0, and both, old and new, would be the same it would to just extra useless calculation and checking.
+			// Since there is no lag calculation and the alpha would always return 0, and both, old and new, would be the same it would to just extra useless calculation and checking.
 			mGraphics->UpdateMeshNode(transform, meshComp);
-#endif // EDITOR
 		}
 
-#ifdef EDITOR
 		for (auto&& [entity, transform ,camera] : mEditorRegistry->view<Transform, CameraComponent>().each())
 		{
 			mGraphics->UpdateCameraNode(transform, camera);
 		}
+	};
 #endif // EDITOR
 
 #ifdef GAME
+	// The sync functions are run as separate tasks at the same time, so they must only read the transforms.
+
+	/**
+	 * @brief Transfer the transforms of the moved entities onto their meshes.
+	 * @param alpha The interpolation state between the old transform and the new transform state
+	 * @param meshObserver Entities with mesh component whose transform was modified
+	*/
+	inline void SyncMeshNodes(float const& alpha, entt::observer& meshObserver)
+	{
+		BenchmarkZone benchmarkZone(mBenchmark, BenchmarkPhase::RenderSync);
+		mMeshRotations.Interpolate(*mRegistry, meshObserver, alpha);
+
+		size_t index = 0;
+		for (auto const& entity : meshObserver)
+		{
+			auto& newState = mRegistry->get<Transform>(entity);
+			auto& meshComp = mRegistry->get<MeshComp>(entity);
+			// Transfer the Transform data from the main component to the mesh data
+			mGraphics->UpdateMeshNode(mRegistry->get<PreviousTransform>(entity), newState, mMeshRotations.mInterpolated[index++], meshComp, alpha);
+		}
 		meshObserver.clear();
+	}
 
+	/**
+	 * @brief Transfer the transforms of the moved entities onto their cameras.
+	 * @param alpha The interpolation state between the old transform and the new transform state
+	 * @param cameraObserver Entities with camera component whose transform was modified
+	*/
+	inline void SyncCameraNodes(float const& alpha, entt::observer& cameraObserver)
+	{
+		BenchmarkZone benchmarkZone(mBenchmark, BenchmarkPhase::RenderSync);
+		mCameraRotations.Interpolate(*mRegistry, cameraObserver, alpha);
+
+		size_t index = 0;
 		for (auto const& entity : cameraObserver)
 		{
 			auto& cameraComp = mRegistry->get<CameraComponent>(entity);
 			auto& newState = mRegistry->get<Transform>(entity);
-			auto oldState = oldTransforms[entity];
-			mGraphics->UpdateCameraNode(oldState, newState, cameraComp, alpha);
+			mGraphics->UpdateCameraNode(mRegistry->get<PreviousTransform>(entity), newState, mCameraRotations.mInterpolated[index++], cameraComp, alpha);
 		}
 		cameraObserver.clear();
+	}
 
+	/**
+	 * @brief Transfer the transforms of the moved entities onto their lights.
+	 * @param alpha The interpolation state between the old transform and the new transform state
+	 * @param lightObserver Entities with light component whose transform was modified
+	*/
+	inline void SyncLightNodes(float const& alpha, entt::observer& lightObserver)
+	{
+		BenchmarkZone benchmarkZone(mBenchmark, BenchmarkPhase::RenderSync);
+		mLightRotations.Interpolate(*mRegistry, lightObserver, alpha);
+
+		size_t index = 0;
 		for (auto const& entity : lightObserver)
 		{
 			auto& newState = mRegistry->get<Transform>(entity);
 			auto& lightComp = mRegistry->get<LightComponent>(entity);
-			auto oldState = oldTransforms[entity];
-			mGraphics->UpdateLightNode(oldState, newState, lightComp, alpha);
+			mGraphics->UpdateLightNode(mRegistry->get<PreviousTransform>(entity), newState, mLightRotations.mInterpolated[index++], lightComp, alpha);
 		}
 		lightObserver.clear();
+	}
+
+	/**
+	 * @brief Store the current transforms of the drawn entities that moved during the last step as the previous ones, before the fixed step moves them again.
+	 * @note Patching makes the graphics observers sync them once more, so that their nodes settle on the final state.
+	 * @param movedDrawables Drawn entities whose transform was modified since the last call.
+	*/
+	inline void StorePreviousTransforms(entt::observer& movedDrawables)
+	{
+		for (auto const& entity : movedDrawables)
+		{
+			auto const& transform = mRegistry->get<Transform>(entity);
+			mRegistry->patch<PreviousTransform>(entity, [&transform](auto& prev) { prev.Store(transform); });
+		}
+		movedDrawables.clear();
+	}
+
+	/**
+	 * @brief Move the physical bodies of the entities that were moved by the game scripts.
+	 * @note This doesn't update physics scale - there is no need yet, but if there was - would multiply the offsets by appropriate axis scale values.
+	 * @param movedBodies Entities with physical bodies whose transform was modified since the last physics response.
+	*/
+	inline void SyncMovedBodies(entt::observer& movedBodies)
+	{
+		for (auto const& entity : movedBodies)
+		{
+			auto const& transform = mRegistry->get<Transform>(entity);
+			mRegistry->get<PhysicalBody>(entity).SetPositionRotation(transform.mPosition, transform.mRotation);
+		}
+		movedBodies.clear();
+	}
 #endif // GAME
-	};
 
 #ifdef GAME
 	/**
 	* @brief Call Update part of the game logic scripts.
 	*/
-	[[nodiscard]] inline YmEventReturn GameScriptsHandling(std::unordered_map<entt::entity, Transform>& oldTransforms)
+	inline void GameScriptsHandling()
 	{
-		YmEventList gameEvents;
 		// Game script - the first modification of the data
-		for (auto&& [entity, scripts] : mRegistry->view<GameLogic>().each())
-		{
-			Transform transformPre(mRegistry->get<Transform>(entity));
-			auto events = scripts.Update(gameTimeStep, *mRegistry, entity);
-			auto& transformPost = mRegistry->get<Transform>(entity);
-
-			if (events.has_value())
-				MergeYmEventLists(gameEvents, events.value());
-			// This doesn't update physics scale - there is no need yet, but if there was - would multiply the offsets by appropriate axis scale values.
-			if (!yamath::opr::Equal(transformPost.mPosition, transformPre.mPosition) ||
-				!yamath::opr::Equal(transformPost.mRotation, transformPre.mRotation))
-			{
-				// Empty Patch just to rise a signal to update, so it is also picked up by the graphics observers.
-				mRegistry->patch<Transform>(entity, [](auto& trfm) {});
-				oldTransforms[entity] = transformPost;
-
-				// This was done in observer before, but issues:
-				// - Initializing the observer in this function caused unknown issues;
-				// - If initialized with other observers it would pick up other patches, which was fixed by clearing before the script loop, but this seems like a more complex and expensive approach (While profiling the difference was minimal);
-				auto* physicsComp = mRegistry->try_get<PhysicalBody>(entity);
-				if(physicsComp)
-					physicsComp->SetPositionRotation(transformPost.mPosition, transformPost.mRotation);
-			}
-		}
-
-		if (gameEvents.size() > 0)
-			return gameEvents;
-		return {};
+		// Scripts move the entities through Transform::Modify, which marks them for the physics and graphics observers.
+		GameLogic::UpdateAll(mTime.GetFixedStep(), *mRegistry, mEventWriter);
 	}
 
 	/**
 	* @brief Call physics handling sections of the game scripts.
 	*/
-	[[nodiscard]] inline YmEventReturn PhysicsResponseHandling(std::unordered_map<entt::entity, Transform>& oldTransforms)
+	inline void PhysicsResponseHandling()
 	{
-		YmEventList gameEvents;
+		// Contact pairs are collected once per step by the physics wrapper, so only the entities in a contact are visited.
+		GameLogic::CollisionUpdates(mPhysics->GetContacts(), mTime.GetFixedStep(), *mRegistry, mEventWriter);
+
 		for (auto&& [entity, transform, physicsComp] : mRegistry->view<Transform, PhysicalBody>().each())
 		{
-			physicsComp.CalculateCollisionCollections();
-
-			auto* gameLogic = mRegistry->try_get<GameLogic>(entity);
-			if (gameLogic)
+			// Only the bodies that the physics engine has written into have a new transform, the rest are skipped without touching Bullet.
+			if (physicsComp.TakeMoved())
 			{
-				auto events = gameLogic->CollisionUpdates(physicsComp, gameTimeStep, *mRegistry);
-
-				if (events.has_value())
-					MergeYmEventLists(gameEvents, events.value());
-			}
-
-			auto currentPos = physicsComp.GetPosition();
-			auto currentRot = physicsComp.GetRotation();
-
-			// This should also take of things (set old transforms) for things that are only moved by scripts.
+				auto currentPos = physicsComp.GetPosition();
+				auto currentRot = physicsComp.GetRotation();
 
-			if (!yamath::opr::Equal(transform.mPosition, currentPos) ||
-				!yamath::opr::Equal(transform.mRotation, currentRot))
-			{
-				// use entity id in a an unsorted map and then access for copy of old state
-				oldTransforms[entity] = transform;
-				mRegistry->patch<Transform>(entity, [currentPos, currentRot](auto& trfm)
-											{
-												trfm.mPosition = currentPos;
-												trfm.mRotation = currentRot;
-											});
+				if (!yamath::opr::Equal(transform.mPosition, currentPos) ||
+					!yamath::opr::Equal(transform.mRotation, currentRot))
+				{
+					Transform::Modify(*mRegistry, entity, [currentPos, currentRot](auto& trfm)
+									  {
+										  trfm.mPosition = currentPos;
+										  trfm.mRotation = currentRot;
+									  });
+				}
 			}
-
-			physicsComp.FlushCollision();
 		}
-
-		if (gameEvents.size() > 0)
-			return gameEvents;
-		return {};
 	}
 
 	/**
-	 * @brief A fixed time game step. Handles game logic scripts, physics update and calling appropriate collision events.
-	 * @param oldTransforms Map for caching transform for the next frame for smoother graphical transition between physics updates.
-	 * @param lag Accumulated lag
-	 * @param gameEvents
+	 * @brief Fixed time game steps for the accumulated game time. Handles game logic scripts, physics update and calling appropriate collision events.
+	 * @param movedDrawables Drawn entities whose transform was modified.
+	 * @param movedBodies Entities with physical bodies whose transform was modified.
 	*/
-	[[nodiscard]] inline YmEventReturn GameStep(std::unordered_map<entt::entity, Transform>& oldTransforms, float& lag
+	inline void GameStep(entt::observer& movedDrawables, entt::observer& movedBodies
 #ifdef PROFILING
 						 , float& gameScriptHandleTime
 						 , float& physicsUpdateTime
@@ -504,89 +719,153 @@ private:
 #endif // PROFILING
 														)
 	{
-		YmEventList gameEvents;
-		while (lag >= gameTimeStep)
+#ifdef PROFILING
+		// Summed up, as there can be multiple steps per frame.
+		gameScriptHandleTime = 0;
+		physicsUpdateTime = 0;
+		physicsResponseTime = 0;
+#endif // PROFILING
+
+		while (mTime.ConsumeFixedStep())
 		{
+			yaprfl::ScopedZone stepZone("Fixed step");
+
+			if (mReplay)
+			{
+				Input::InputState state;
+				if (!mReplay->NextStep(state))
+					break;
+				mInput.ApplyState(state);
+			}
+			else if (mRecorder)
+			{
+				mRecorder->RecordStep(mInput.CaptureState());
+			}
+
+			StorePreviousTransforms(movedDrawables);
 #ifdef PROFILING
 			mWatch.Start();
 #endif // PROFILING
-			auto gameScriptEvents = GameScriptsHandling(oldTransforms);
-			if (gameScriptEvents.has_value())
-				MergeYmEventLists(gameEvents, gameScriptEvents.value());
+			{
+				yaprfl::ScopedZone zone("Scripts");
+				BenchmarkZone benchmarkZone(mBenchmark, BenchmarkPhase::Scripts);
+				GameScriptsHandling();
+
+				SyncMovedBodies(movedBodies);
+			}
 
 #ifdef PROFILING
-			gameScriptHandleTime = mWatch.SecondsPassed();
+			gameScriptHandleTime += mWatch.SecondsPassed();
 			mWatch.Start();
 #endif // PROFILING
 
-			mPhysics->Update(gameTimeStep);
+			{
+				yaprfl::ScopedZone zone("Physics step");
+				BenchmarkZone benchmarkZone(mBenchmark, BenchmarkPhase::PhysicsStep);
+				mPhysics->Update(mTime.GetFixedStep());
+
+				// Queries see the world of this step, the scripts read their results in the next one.
+				yaprfl::ScopedZone queriesZone("Physics queries");
+				mPhysics->RunQueries(mRegistry->ctx<PhysicsQueries>());
+			}
+			RecordPhysicsCounters();
 #ifdef PROFILING
-			physicsUpdateTime = mWatch.SecondsPassed();
+			physicsUpdateTime += mWatch.SecondsPassed();
 			mWatch.Start();
 #endif // PROFILING
 
-			auto physicsResponseEvents =  PhysicsResponseHandling(oldTransforms);
-			if (physicsResponseEvents.has_value())
-				MergeYmEventLists(gameEvents, physicsResponseEvents.value());
+			{
+				yaprfl::ScopedZone zone("Physics response");
+				BenchmarkZone benchmarkZone(mBenchmark, BenchmarkPhase::PhysicsResponse);
+				PhysicsResponseHandling();
+
+				// The bodies already are where the physics engine has put them.
+				movedBodies.clear();
+			}
 #ifdef PROFILING
-			physicsResponseTime = mWatch.SecondsPassed();
+			physicsResponseTime += mWatch.SecondsPassed();
 #endif // PROFILING
 
 			mInput.Update();
-			lag -= gameTimeStep;
 		}
+	}
 
-		if (gameEvents.size() > 0)
-			return gameEvents;
-		return {};
+	/**
+	 * @brief Put the counters of the last physics step into the trace and the benchmark.
+	*/
+	inline void RecordPhysicsCounters()
+	{
+		auto const& stats = mPhysics->GetStepStats();
+		yaprfl::RecordCounters("Physics bodies", { {"Active", stats.mActiveBodies}, {"Sleeping", stats.mSleepingBodies}, {"Islands", stats.mIslands} });
+		yaprfl::RecordCounters("Physics contacts", { {"Broad-phase pairs", stats.mBroadphasePairs}, {"Manifolds", stats.mManifolds}, {"Contact points", stats.mContactPoints} });
+		yaprfl::RecordCounters("Physics solver", { {"Iterations", stats.mSolverIterations} });
+
+		if (!mBenchmark.IsActive())
+			return;
+
+		mBenchmark.SetCounter(BenchmarkCounter::ActiveBodies, stats.mActiveBodies);
+		mBenchmark.SetCounter(BenchmarkCounter::SleepingBodies, stats.mSleepingBodies);
+		mBenchmark.SetCounter(BenchmarkCounter::BroadphasePairs, stats.mBroadphasePairs);
+		mBenchmark.SetCounter(BenchmarkCounter::Manifolds, stats.mManifolds);
+		mBenchmark.SetCounter(BenchmarkCounter::ContactPoints, stats.mContactPoints);
+		mBenchmark.SetCounter(BenchmarkCounter::SolverIterations, stats.mSolverIterations);
+		mBenchmark.SetCounter(BenchmarkCounter::Islands, stats.mIslands);
+		mBenchmark.CountersSet();
 	}
 
 	/**
 	 * @brief Inits that need to be called before the game loop.
-	 * @param gameEvents The game event queue
-	 * @param oldTransforms Map for caching old transforms, that will be used for smoother interpolation between the physics updates.
 	*/
-	inline void PreGameLoopInits(YmEventList& gameEvents, std::unordered_map<entt::entity, Transform> oldTransforms)
+	inline void PreGameLoopInits()
 	{
-
-		// Components that have neither the game logic, nor physical bodies, meaning they will not change in position - thus old state will only be set before the game loop
-
-		for (auto&& [entity, transform, _] : mRegistry->view<Transform, CameraComponent>(entt::exclude<PhysicalBody, GameLogic>).each())
+		// Update physics based on the transform as the component has no idea about the position
+		for (auto&& [entity, transform, physicsComp] : mRegistry->view<Transform, PhysicalBody>().each())
 		{
-			oldTransforms[entity] = transform;
+			physicsComp.SetPositionRotation(transform.mPosition, transform.mRotation, true);
 		}
 
-		for (auto&& [entity, transform, _] : mRegistry->view<Transform, LightComponent>(entt::exclude<PhysicalBody, GameLogic>).each())
-		{
-			oldTransforms[entity] = transform;
-		}
+		GameLogic::StartAll(mTime.GetFixedStep(), *mRegistry, mEventWriter);
 
-		// Update physics based on the transform as the component has no idea about the position
+		// Taken after the scripts have started, as they can change the bodies (e.g. disable the sleeping).
+		mSceneStartSnapshot = mPhysics->CaptureSnapshot();
+	}
+
+	/**
+	 * @brief Put the physics bodies back to their state after the scene load and move their entities along.
+	*/
+	inline void RestoreScenePhysics()
+	{
+		auto restored = mPhysics->RestoreSnapshot(mSceneStartSnapshot);
+		// Results of the queries were made in the old world.
+		mRegistry->ctx<PhysicsQueries>().Clear();
+
+		// Triggers are not moved through a motion state, so every body is compared against its entity.
 		for (auto&& [entity, transform, physicsComp] : mRegistry->view<Transform, PhysicalBody>().each())
 		{
-			physicsComp.SetPositionRotation(transform.mPosition, transform.mRotation);
-		}
+			physicsComp.TakeMoved();
+			auto position = physicsComp.GetPosition();
+			auto rotation = physicsComp.GetRotation();
 
-		for (auto&& [entity, scripts] : mRegistry->view<GameLogic>().each())
-		{
-			auto events = scripts.Start(gameTimeStep, *mRegistry, entity);
-			if (events.has_value())
-				MergeYmEventLists(gameEvents, events.value());
+			if (!yamath::opr::Equal(transform.mPosition, position) || !yamath::opr::Equal(transform.mRotation, rotation))
+			{
+				Transform::Modify(*mRegistry, entity, [position, rotation](auto& trfm)
+								  {
+									  trfm.mPosition = position;
+									  trfm.mRotation = rotation;
+								  });
+			}
 		}
+
+		Log(LGR_INFO, std::format("Restored {} physics bodies from a {} byte snapshot", restored, mSceneStartSnapshot.GetSize()));
 	}
 #endif // GAME
 
 	/**
 	 * @brief Prepares the graphics entities for the game loop.
 		Refreshes the transforms so that the graphics related observes can react.
-		Caches transforms, so that the graphical objects that do not move can still be drawn.
+		Gives the drawn entities their previous transform, so that they can be interpolated between the fixed steps.
 	*/
-	inline void PrepareGraphicEntities(
-#ifdef GAME
-		std::unordered_map<entt::entity, Transform>& oldTransforms
-#endif // GAME
-
-	)
+	inline void PrepareGraphicEntities()
 	{
 		for (auto&& [entity, transform] : mRegistry->view<Transform>().each())
 		{
@@ -605,10 +884,38 @@ private:
 										});
 
 #ifdef GAME
-			oldTransforms[entity] = transform;
+			mRegistry->emplace_or_replace<PreviousTransform>(entity).Store(transform);
 #endif // GAME
 
 		}
+
+#ifdef GAME
+		// Keep the previous transforms in the same order as the transforms, so that iterating both walks the memory forward.
+		mRegistry->sort<PreviousTransform, Transform>();
+#endif // GAME
+	}
+
+	/**
+	 * @brief Check if the headless run has reached its frame or time limit.
+	 * @return Always false when running with a window.
+	*/
+	inline bool HeadlessLimitReached()
+	{
+#ifdef GAME
+		if (!mRunSettings.mHeadless)
+			return false;
+
+		if (mReplay && mReplay->IsFinished())
+			return true;
+
+		if (mRunSettings.mFrameLimit > 0 && mRunSummary.mFrames >= mRunSettings.mFrameLimit)
+			return true;
+
+		if (mRunSettings.mSecondsLimit > 0 && mRunSummary.SecondsSinceStart() >= mRunSettings.mSecondsLimit)
+			return true;
+#endif // GAME
+
+		return false;
 	}
 public:
 
@@ -620,10 +927,28 @@ public:
 	void InitEngine(int argc, char* argv[])
 	{
 		InitLogger(argc, argv);
+		yaprfl::SetThreadName("Main");
 		// Initialize from data here
 		mInit.LoadConfig(PathToConfigFile);
 
 		mInit.LoadLoggingFiles();
+
+#ifdef GAME
+		mRunSettings = mInit.GetRunSettings();
+		ApplyCommandLine(mRunSettings, argc, argv);
+
+		auto seed = InitReplay();
+
+		if (!mRunSettings.mBenchmarkPath.empty())
+		{
+			Log(LGR_INFO, std::format("Running a benchmark of scene {}, skipping the first {} frames", mRunSettings.mStartScene, mRunSettings.mWarmupFrames));
+			mBenchmark.Start(mRunSettings.mWarmupFrames);
+		}
+
+		if (mRunSettings.mHeadless)
+			Log(LGR_INFO, std::format("Running headless. Frame limit: {}, seconds limit: {}", mRunSettings.mFrameLimit, mRunSettings.mSecondsLimit));
+#endif // GAME
+
 #ifdef PROFILING
 		yaprfl::Init();
 		mWatch.Start();
@@ -633,20 +958,47 @@ public:
 		auto [width, height] = mInit.GetResolution();
 		mInput.Init(GUI::Instance().GetImguiEventReceiver(), height, width);
 
-		mGraphics = std::make_unique<GraphicsWrapper>(width, height, mInput.GetHandler());
-		GUI::Instance().InitUI(mGraphics->GetDevice(), height, width);
+		mGraphics = std::make_unique<GraphicsWrapper>(width, height, mInput.GetHandler(), false, mRunSettings.GetDriver());
+
+		// IMGUI needs an actual render target.
+		if (!mRunSettings.mHeadless)
+			GUI::Instance().InitUI(mGraphics->GetDevice(), height, width);
 		mInput.SetCursorControl(mGraphics->GetCursorControl());
 
+		// Started before the physics, which can run on the same workers.
+		JobSystem::Instance().Init(mInit.GetWorkerThreadCount());
+
 #ifdef GAME
-		Audio::Init();
+		Audio::Init(mRunSettings.mHeadless);
 		mInit.LoadScenesConfigs();
-		mPhysics = std::make_unique<PhysicsWrapper>();
+		mPhysics = std::make_unique<PhysicsWrapper>(mInit.GetPhysicsThreadCount());
 		mInit.mPhysics = mPhysics.get();
+		mPhysics->SetCollisionLayers(mInit.GetCollisionLayers());
+		mPhysics->SetMeshSource([this](std::string const& meshPath)
+								{
+									MeshGeometry geometry;
+									mGraphics->GetMeshGeometry(meshPath, geometry.mVertices, geometry.mIndices);
+									return geometry;
+								});
 #endif // GAME
 		mInit.mGraphics = mGraphics.get();
 
+#ifdef GAME
+		if (mRunSettings.mBakeColliders)
+		{
+			// Baking is an offline step, so the game closes right after it.
+			if (!mInit.BakeColliders())
+				mExitCode = 1;
+			mUserExit = true;
+		}
+#endif // GAME
 
 		mRegistry = new entt::registry();
+#ifdef GAME
+		// Scripts add their world queries here, the context survives the scene changes.
+		mRegistry->set<PhysicsQueries>();
+#endif // GAME
+		RegisterEventHandlers();
 
 #ifdef EDITOR
 		mEditorRegistry = new entt::registry();
@@ -661,7 +1013,14 @@ public:
 
 
 #ifdef GAME
-		mInit.LoadSceneById(1, *mRegistry);
+		mInit.LoadSceneById(mRunSettings.mStartScene, *mRegistry);
+
+		auto startFixedStep = mInit.GetSceneTimeSettings().mFixedStep;
+		if (mRecorder)
+			mRecorder->Begin(seed, mRunSettings.mStartScene, startFixedStep);
+
+		if (mReplay && mReplay->GetFixedStep() != startFixedStep)
+			Log(LGR_WARNING, std::format("Replay was recorded with a fixed step of {}, but the scene uses {}. The session will not match the recording.", mReplay->GetFixedStep(), startFixedStep));
 #endif // GAME
 
 #ifdef EDITOR
@@ -680,65 +1039,105 @@ public:
 	*/
 	void GameLoop()
 	{
+#ifdef GAME
+		mRunSummary.mStart = std::chrono::steady_clock::now();
+#endif // GAME
+
+		if (!mRunSettings.mTracePath.empty())
+			yaprfl::StartCapture();
+
 		do
 		{
-			YmEventList gameEvents;
 #pragma region Pre loop
 #ifdef GAME
 			mLoadNewScene = false;
-			auto meshObserver = entt::observer{ *mRegistry, entt::collector.update<Transform>().where<MeshComp>() };
-			auto cameraObserver = entt::observer{ *mRegistry, entt::collector.update<Transform>().where<CameraComponent>() };
-			auto lightObserver = entt::observer{ *mRegistry, entt::collector.update<Transform>().where<LightComponent>() };
-			std::unordered_map<entt::entity, Transform> oldTransforms;
+			auto meshObserver = entt::observer{ *mRegistry, entt::collector.update<Transform>().where<MeshComp>().update<PreviousTransform>().where<MeshComp>() };
+			auto cameraObserver = entt::observer{ *mRegistry, entt::collector.update<Transform>().where<CameraComponent>().update<PreviousTransform>().where<CameraComponent>() };
+			auto lightObserver = entt::observer{ *mRegistry, entt::collector.update<Transform>().where<LightComponent>().update<PreviousTransform>().where<LightComponent>() };
+			auto movedDrawables = entt::observer{ *mRegistry, entt::collector.update<Transform>().where<PreviousTransform>() };
+			auto movedBodies = entt::observer{ *mRegistry, entt::collector.update<Transform>().where<PhysicalBody>() };
 #endif // GAME
 
-			PrepareGraphicEntities(
+			PrepareGraphicEntities();
+
+			// The loop is inspired by https://gameprogrammingpatterns.com/game-loop.html
+			mTime.Reset(
 #ifdef GAME
-				oldTransforms
+				mInit.GetSceneTimeSettings()
 #endif // GAME
+#ifdef EDITOR
+				mInit.GetTimeSettings()
+#endif // EDITOR
 			);
 
-			// The loop is inspired by https://gameprogrammingpatterns.com/game-loop.html
-			float lag = 0.0f;
-			auto previousTime = std::chrono::system_clock::now();
-
 #ifdef GAME
-			PreGameLoopInits(gameEvents, oldTransforms);
+			PreGameLoopInits();
+
+#ifdef PROFILING
+			float gameScriptHandleTime = 0;
+			float physicsUpdateTime = 0;
+			float physicsResponseTime = 0;
+#endif // PROFILING
+
+			// The interpolation state between the old transform and the new transform state.
+			float alpha = 0;
+
+			// The game step runs on the main thread before the graph, as the scripts, input, audio and physics are not thread safe.
+			// The graphical nodes of different types only read the moved transforms, so they can be synced at the same time.
+			TaskGraph frameGraph;
+			frameGraph.AddTask("Mesh sync", ComponentIds<Transform, PreviousTransform>(), ComponentIds<MeshComp>(), [&]() { SyncMeshNodes(alpha, meshObserver); });
+			frameGraph.AddTask("Camera sync", ComponentIds<Transform, PreviousTransform>(), ComponentIds<CameraComponent>(), [&]() { SyncCameraNodes(alpha, cameraObserver); });
+			frameGraph.AddTask("Light sync", ComponentIds<Transform, PreviousTransform>(), ComponentIds<LightComponent>(), [&]() { SyncLightNodes(alpha, lightObserver); });
 #endif // GAME
 
 
 #ifdef EDITOR
-			for (auto&& [entity, scripts] : mEditorRegistry->view<GameLogic>().each())
-			{
-				auto events = scripts.Start(gameTimeStep, *mRegistry, entity);
-				if (events.has_value())
-					MergeYmEventLists(gameEvents, events.value());
-			}
+			// The editor scripts get the scene registry through the data vault.
+			GameLogic::StartAll(mTime.GetFixedStep(), *mEditorRegistry, mEventWriter);
 #endif // EDITOR
 
 
 #pragma endregion
 
-			while (mGraphics->IsDeviceRunning() && !mUserExit && !GUI::Instance().GetMenuQuit())
+			while (mGraphics->IsDeviceRunning() && !mUserExit && !GUI::Instance().GetMenuQuit() && !HeadlessLimitReached())
 			{
+#ifdef GAME
+				mBenchmark.BeginFrame();
+				BenchmarkZone frameBenchmarkZone(mBenchmark, BenchmarkPhase::Frame);
+#endif // GAME
+				yaprfl::ScopedZone frameZone("Frame");
 #pragma region Time Calculations
 				// Calculate how much time was produced.
-				auto currentTime = std::chrono::system_clock::now();
-				std::chrono::duration<float> elapsedTime = currentTime - previousTime;
-				previousTime = currentTime;
+				auto realtimeDeltaTime = mTime.Tick();
 #ifdef GAME
-				lag += elapsedTime.count();
+				// Headless runs advance exactly one game step per frame, so that the runs are comparable regardless of how fast the machine is.
+				if (mRunSettings.mHeadless)
+				{
+					mRunSummary.AddFrame(realtimeDeltaTime, mTime.GetFixedStep());
+					mTime.AccumulateFixedStep();
+				}
+				else
+				{
+					mTime.Accumulate(realtimeDeltaTime);
+				}
 #endif // GAME
-#ifdef EDITOR
-				auto realtimeDeltaTime = elapsedTime.count();
-#endif // EDITOR
 
 
 #pragma endregion
 
-				HandleEvents(gameEvents);
+				{
+					yaprfl::ScopedZone zone("Events");
+					mEvents.Dispatch();
+				}
 
 #ifdef GAME
+				if (mReplay)
+				{
+					auto sceneChange = mReplay->PopSceneChange();
+					if (sceneChange.has_value())
+						LoadScene(sceneChange.value());
+				}
+
 				if (mLoadNewScene)
 				{
 					// Was thinking about using goto here, but it doesn't simplify the code, as it would only replace the do-while - the bool flag and the check are still necessary as the event handling happens inside a different function
@@ -747,20 +1146,18 @@ public:
 
 #pragma region Game step
 
+				{
+					yaprfl::ScopedZone zone("Game step");
+					GameStep(movedDrawables, movedBodies
 #ifdef PROFILING
-				float gameScriptHandleTime;
-				float physicsUpdateTime;
-				float physicsResponseTime;
-#endif // PROFILING
-
-				auto gameStepEvents = GameStep(oldTransforms, lag
-#ifdef PROFILING
-						 ,gameScriptHandleTime, physicsUpdateTime, physicsResponseTime
+							 , gameScriptHandleTime, physicsUpdateTime, physicsResponseTime
 #endif // PROFILING
-				);
+					);
+				}
+				alpha = mTime.GetAlpha();
 
-				if (gameStepEvents.has_value())
-					MergeYmEventLists(gameEvents, gameStepEvents.value());
+				// Updates the graphical nodes of the entities that have moved.
+				frameGraph.Execute(JobSystem::Instance());
 
 				// The input update has to be called withing the game step so that the cleared data is not gone between them, as that's the only time the user can interact and handle said inputs
 				// While in the engine there is no physics time limitations
@@ -768,12 +1165,7 @@ public:
 #endif // GAME
 
 #ifdef EDITOR
-				for (auto&& [entity, scripts] : mEditorRegistry->view<GameLogic>().each())
-				{
-					auto events = scripts.Update(realtimeDeltaTime, *mEditorRegistry, entity);
-					if (events.has_value())
-						MergeYmEventLists(gameEvents, events.value());
-				}
+				GameLogic::UpdateAll(realtimeDeltaTime, *mEditorRegistry, mEventWriter);
 				// While it is not really expected to use Input::Get... in editor, as most of it is handled within ImGUI (for now), but it could cause headaches if something was using it
 				mInput.Update();
 #endif // EDITOR
@@ -785,48 +1177,59 @@ public:
 #ifdef PROFILING
 				mWatch.Start();
 #endif // PROFILING
-
-
-				auto alpha = lag / gameTimeStep;
-				RenderableObjectHandling(
+				yaprfl::ScopedZone drawZone("Draw");
 #ifdef GAME
-					alpha, meshObserver, cameraObserver, lightObserver, oldTransforms
+				BenchmarkZone drawBenchmarkZone(mBenchmark, BenchmarkPhase::Draw);
 #endif // GAME
-				);
+
+#ifdef EDITOR
+				RenderableObjectHandling();
+#endif // EDITOR
 
 				mGraphics->BeginScene();
+
+				if (mRunSettings.mHeadless)
+				{
+					mGraphics->DrawScene();
+					mGraphics->EndScene();
+					continue;
+				}
+
 				GUI::Instance().StartDrawing();
 
 				// Call any kind of GUI related items from game scripts
-				for (auto && [entity, scripts] :
+				GameLogic::DrawAll(
 #ifdef GAME
-					 mRegistry
+					*mRegistry
 #endif // GAME
 #ifdef EDITOR
-					 mEditorRegistry
+					*mEditorRegistry
 #endif
-					 ->view<GameLogic>().each())
-				{
-					auto events = scripts.DrawGraphicalItems();
-					if (events.has_value())
-						MergeYmEventLists(gameEvents, events.value());
-				}
+					, mEventWriter);
 
 				// Probably make this the update of the scene, which will take the transform comp and graphics comp and then just give update the graphics comp
 				mGraphics->DrawScene();
 #ifdef PROFILING
 				auto drawingTime = mWatch.SecondsPassed();
-				GUI::Instance().DrawStats(mGraphics->GetFPS(), mGraphics->GetDrawnPrimitives(), yaprfl::GetUsedMemory(), yaprfl::GetCPUUsage(), drawingTime
+				auto& frameHistory = mTime.GetHistory();
+				GUI::Instance().DrawStats(mGraphics->GetFPS(), mGraphics->GetDrawnPrimitives(), yaprfl::GetUsedMemory(), yaprfl::GetCPUUsage(), drawingTime, frameHistory.GetAverage(), frameHistory.GetWorst()
 #ifdef GAME
 										  , gameScriptHandleTime
 										  , physicsUpdateTime
 										  , physicsResponseTime
+										  , mPhysics->CountLayerPairs()
+										  , mPhysics->GetStepStats()
+										  , mTime.GetStepsThisFrame()
+										  , mTime.GetDroppedTime()
 #endif // GAME
 											);
 #endif // PROFILING
 				GUI::Instance().StopDrawing();
 
 				mGraphics->EndScene();
+
+				// Headless runs are not limited, as they are meant to finish as soon as possible.
+				mTime.LimitFrameRate();
 #pragma endregion
 			}
 		} while (
@@ -836,6 +1239,35 @@ public:
 			false
 #endif // GAME
 			);
+
+#ifdef GAME
+		if (mRunSettings.mHeadless)
+			mRunSummary.LogSummary();
+
+		if (mRecorder)
+			mRecorder->Save(mRunSettings.mRecordPath);
+
+		if (mBenchmark.IsActive())
+		{
+			mBenchmark.EndFrames();
+			if (!mBenchmark.Report(mRunSettings))
+				mExitCode = 1;
+		}
+#endif // GAME
+
+		if (!mRunSettings.mTracePath.empty())
+		{
+			yaprfl::StopCapture();
+			yaprfl::ExportChromeTrace(mRunSettings.mTracePath);
+		}
+	}
+
+	/**
+	 * @brief Get the code that the process should return.
+	*/
+	inline int GetExitCode() const noexcept
+	{
+		return mExitCode;
 	}
 
 	/**
@@ -843,6 +1275,8 @@ public:
 	*/
 	void Cleanup()
 	{
+		JobSystem::Instance().Shutdown();
+
 		if (mRegistry)
 			delete mRegistry;
 
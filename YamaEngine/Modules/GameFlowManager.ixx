@@ -21,12 +21,11 @@ private:
 	*/
 	float currentTime = 0;
 public:
-	[[nodiscard]] inline YmEventReturn Update(float deltaTime, entt::registry& registry, entt::entity const& thisEntity) override
+	inline void Update(float deltaTime, entt::registry& registry, entt::entity const& thisEntity, EventWriter& events) override
 	{
-		YmEventList inputEvents;
 		if (Input::GetKeyPressed(Input::KC_ESC))
 		{
-			inputEvents.emplace_back(YmEventTypes::ExitApplication, nullptr);
+			events.Emit(ExitApplicationEvent{});
 		}
 
 		else
@@ -35,22 +34,25 @@ public:
 			{
 				if (Input::GetKeyPressed(Input::KC_F1))
 				{
-					inputEvents.emplace_back(YmEventTypes::ChangeScene, new SceneChangeMessage{ 1 });
+					events.Emit(ChangeSceneEvent{ 1 });
 					currentTime = 0.f;
 				}
 
 				else if (Input::GetKeyPressed(Input::KC_F2))
 				{
-					inputEvents.emplace_back(YmEventTypes::ChangeScene, new SceneChangeMessage{ 2 });
+					events.Emit(ChangeSceneEvent{ 2 });
+					currentTime = 0.f;
+				}
+
+				else if (Input::GetKeyPressed(Input::KC_F5))
+				{
+					events.Emit(RestorePhysicsEvent{});
 					currentTime = 0.f;
 				}
 			}
 		}
 
 		currentTime += deltaTime;
-		if (inputEvents.size() > 0)
-			return inputEvents;
-		return {};
 	}
 };
 #endif // GAME
@@ -17,197 +17,366 @@ import GameLogic.EditorCameraManager;
 import GameLogic.SceneEditor;
 #endif // EDITOR
 
-import <memory>;
-import <vector>;
+import <array>;
 import <string>;
-import <functional>;
-import <set>;
+import <string_view>;
+import <vector>;
+import <type_traits>;
 import YamaEvents;
 
+// Every script type is stored as its own component, so the instances of a type sit next to each other in the registry.
+// The engine updates one type at a time, calling the functions of the concrete type, so the calls are not virtual and the data is read in order.
+// GameLogic only remembers which types the entity has, which is needed to call the collision functions of the entities in a contact.
+// Hooks that a type does not override are found at compile time, and the type is left out of the lists of that hook, so the empty defaults are never called.
+
 /**
- * @brief Component responsible for managing many game scripts.
+ * @brief Hash of the script name, so that the type can be found without comparing the strings.
+ * @note FNV-1a.
 */
-export class GameLogic
+export constexpr unsigned int HashScriptName(std::string_view const& name)
+{
+	unsigned int hash = 2166136261u;
+	for (auto const& character : name)
+	{
+		hash ^= (unsigned char)character;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+/**
+ * @brief Flags of the script hooks.
+*/
+enum ScriptHooks
+{
+	HookStart = 1 << 0,
+	HookUpdate = 1 << 1,
+	HookDraw = 1 << 2,
+	HookCollisionEnter = 1 << 3,
+	HookCollisionStay = 1 << 4,
+	HookCollisionExit = 1 << 5,
+	HookCollision = HookCollisionEnter | HookCollisionStay | HookCollisionExit
+};
+
+/**
+ * @brief Check if the script overrides the hook, as without the override the member pointer has the base class type.
+*/
+template<typename Script, typename Hook>
+constexpr bool Overrides(Hook Script::*)
+{
+	return !std::is_same_v<Script, GameScriptBase>;
+}
+
+/**
+ * @brief Get the hooks that the script type overrides.
+*/
+template<typename Script>
+constexpr unsigned int GetOverriddenHooks()
+{
+	unsigned int hooks = 0;
+	hooks |= Overrides(&Script::Start) ? HookStart : 0;
+	hooks |= Overrides(&Script::Update) ? HookUpdate : 0;
+	hooks |= Overrides(&Script::DrawItems) ? HookDraw : 0;
+#ifdef GAME
+	hooks |= Overrides(&Script::OnCollisionEnter) ? HookCollisionEnter : 0;
+	hooks |= Overrides(&Script::OnCollisionStay) ? HookCollisionStay : 0;
+	hooks |= Overrides(&Script::OnCollisionExit) ? HookCollisionExit : 0;
+#endif // GAME
+	return hooks;
+}
+
+/**
+ * @brief Functions of a single script type. Each of them goes through every instance of that type.
+*/
+struct ScriptType
 {
-private:
 	/**
-	 * @brief The collection of scripts.
+	 * @brief Hash of the name used in the scene files.
 	*/
-	std::vector<std::unique_ptr<GameScriptBase>> mGameLogicScripts;
+	unsigned int mNameHash;
 
-#ifdef GAME
 	/**
-	 * @brief A Pair of 2 lambdas for handling a physics event. First one will fetch a set of entity IDs that the collision and the second one will call appropriate function to handle said physics event.
+	 * @brief Name used in the scene files.
 	*/
-	typedef std::pair<std::function<std::set<int>(PhysicalBody&)>, std::function<YmEventReturn(GameScriptBase*, float dt, entt::registry&, entt::entity const&, entt::entity const&)>> CollisionCallPair;
-
-	std::vector<CollisionCallPair> collisionCalls = {
-		// On Collision Exit
-		std::make_pair(
-			[](PhysicalBody& physicalBody) ->std::set<int> { return physicalBody.GetItemsLeftCollisionWith(); },
-			[](GameScriptBase* script, float dt, entt::registry& registry, entt::entity const& thisEntity, entt::entity const& thatEntity) -> YmEventReturn { return script->OnCollisionExit(dt, registry, thisEntity, thatEntity); }),
-
-		// On Collision Enter
-		std::make_pair(
-			[](PhysicalBody& physicalBody) ->std::set<int> { return physicalBody.GetItemsEnterdCollisionWith(); },
-			[](GameScriptBase* script, float dt, entt::registry& registry, entt::entity const& thisEntity, entt::entity const& thatEntity) -> YmEventReturn { return script->OnCollisionEnter(dt, registry, thisEntity, thatEntity); }),
-
-		//On Collision Stay
-		std::make_pair(
-			[](PhysicalBody& physicalBody) ->std::set<int> { return physicalBody.GetItemsStayedCollisionWith(); },
-			[](GameScriptBase* script, float dt, entt::registry& registry, entt::entity const& thisEntity, entt::entity const& thatEntity) -> YmEventReturn { return script->OnCollisionStay(dt, registry, thisEntity, thatEntity); })
-	};
+	std::string_view mName;
+
+	/**
+	 * @brief Hooks that the type overrides.
+	*/
+	unsigned int mHooks;
+
+	void (*mAdd)(entt::registry&, entt::entity);
+	void (*mStart)(float, entt::registry&, EventWriter&);
+	void (*mUpdate)(float, entt::registry&, EventWriter&);
+	void (*mDraw)(entt::registry&, EventWriter&);
+#ifdef GAME
+	void (*mCollide)(ScriptHooks, float, entt::registry&, entt::entity, entt::entity, EventWriter&);
 #endif // GAME
+};
 
-public:
+/**
+ * @brief Create the functions for the script type.
+ * @param name Name used in the scene files.
+*/
+template<typename Script>
+constexpr ScriptType MakeScriptType(std::string_view const name)
+{
+	static_assert(std::is_base_of_v<GameScriptBase, Script>, "Scripts have to inherit from GameScriptBase");
 
+	// The qualified calls (script.Script::Update) are resolved at compile time, so they skip the virtual table.
+	return ScriptType{
+		.mNameHash = HashScriptName(name),
+		.mName = name,
+		.mHooks = GetOverriddenHooks<Script>(),
+		.mAdd = [](entt::registry& registry, entt::entity entity) { registry.emplace<Script>(entity); },
+		.mStart = [](float deltaTime, entt::registry& registry, EventWriter& events)
+		{
+			for (auto&& [entity, script] : registry.view<Script>().each())
+				script.Script::Start(deltaTime, registry, entity, events);
+		},
+		.mUpdate = [](float deltaTime, entt::registry& registry, EventWriter& events)
+		{
+			for (auto&& [entity, script] : registry.view<Script>().each())
+				script.Script::Update(deltaTime, registry, entity, events);
+		},
+		.mDraw = [](entt::registry& registry, EventWriter& events)
+		{
+			for (auto&& [entity, script] : registry.view<Script>().each())
+				script.Script::DrawItems(events);
+		},
+#ifdef GAME
+		.mCollide = [](ScriptHooks hook, float deltaTime, entt::registry& registry, entt::entity thisEntity, entt::entity thatEntity, EventWriter& events)
+		{
+			constexpr auto hooks = GetOverriddenHooks<Script>();
+			auto& script = registry.get<Script>(thisEntity);
 
-	/**
-	 * @brief Calls the start section of the game logic scripts.
-	*/
-	[[nodiscard]] inline YmEventReturn Start(float deltaTime, entt::registry& registry, entt::entity const& thisEntity)
+			if constexpr ((hooks & HookCollisionExit) != 0)
+			{
+				if (hook == HookCollisionExit)
+					script.Script::OnCollisionExit(deltaTime, registry, thisEntity, thatEntity, events);
+			}
+
+			if constexpr ((hooks & HookCollisionEnter) != 0)
+			{
+				if (hook == HookCollisionEnter)
+					script.Script::OnCollisionEnter(deltaTime, registry, thisEntity, thatEntity, events);
+			}
+
+			if constexpr ((hooks & HookCollisionStay) != 0)
+			{
+				if (hook == HookCollisionStay)
+					script.Script::OnCollisionStay(deltaTime, registry, thisEntity, thatEntity, events);
+			}
+		},
+#endif // GAME
+	};
+}
+
+/**
+ * @brief Every script type that can be used in the scene files. New scripts have to be added here.
+ * @note The order of the table is the order in which the types are updated.
+*/
+constexpr std::array ScriptTypes{
+#ifdef GAME
+	MakeScriptType<GameFlowManager>("GameFlowManager"),
+	MakeScriptType<PlayerMovement>("PlayerMovement"),
+	MakeScriptType<AIWalker>("AIWalker"),
+	MakeScriptType<ReactiveItem>("Reactive"),
+	MakeScriptType<PlayerScoreTracker>("ScoreTracker"),
+	MakeScriptType<MainMenu>("MainMenu"),
+	MakeScriptType<ScoreSubmission>("ScoreSubmission"),
+#endif // GAME
+
+#ifdef EDITOR
+	MakeScriptType<EditorCameraManager>("EditorCamera"),
+	MakeScriptType<SceneEditor>("SceneEditor"),
+#endif // EDITOR
+};
+
+/**
+ * @brief Check that no two script names have the same hash.
+*/
+constexpr bool ScriptHashesAreUnique()
+{
+	for (size_t i = 0; i < ScriptTypes.size(); i++)
 	{
-		YmEventList eventList;
-		for (auto& script : mGameLogicScripts)
+		for (size_t j = i + 1; j < ScriptTypes.size(); j++)
 		{
-			auto events = script->Start(deltaTime, registry, thisEntity);
-			if (events.has_value())
-				MergeYmEventLists(eventList, events.value());
+			if (ScriptTypes[i].mNameHash == ScriptTypes[j].mNameHash)
+				return false;
 		}
+	}
+	return true;
+}
 
-		if (eventList.size() > 0)
-			return eventList;
+static_assert(ScriptHashesAreUnique(), "Two script names have the same hash, rename one of them");
+static_assert(ScriptTypes.size() <= 32, "Script types of an entity are stored as 32 bit flags");
 
-		return {};
-	}
+/**
+ * @brief Script types that override a hook.
+*/
+struct HookSubscribers
+{
+	/**
+	 * @brief Indices in the script type table.
+	*/
+	std::array<unsigned char, ScriptTypes.size()> mTypes{};
 
 	/**
-	 * @brief Calls the update section of the game logic scripts.
+	 * @brief Amount of used indices.
 	*/
-	[[nodiscard]] inline YmEventReturn Update(float deltaTime, entt::registry& registry, entt::entity const& thisEntity)
-	{
-		YmEventList eventList;
-		for (auto& script : mGameLogicScripts)
-		{
-			auto events = script->Update(deltaTime, registry, thisEntity);
+	size_t mCount = 0;
 
-			if (events.has_value())
-				MergeYmEventLists(eventList, events.value());
-		}
+	/**
+	 * @brief Same as the indices, but as the flags used by GameLogic.
+	*/
+	unsigned int mFlags = 0;
+};
 
-		if (eventList.size() > 0)
-			return eventList;
+/**
+ * @brief Collect the script types that override any of the hooks.
+*/
+constexpr HookSubscribers FindSubscribers(unsigned int const hooks)
+{
+	HookSubscribers subscribers;
+	for (size_t i = 0; i < ScriptTypes.size(); i++)
+	{
+		if ((ScriptTypes[i].mHooks & hooks) == 0)
+			continue;
 
-		return {};
+		subscribers.mTypes[subscribers.mCount++] = (unsigned char)i;
+		subscribers.mFlags |= 1u << i;
 	}
+	return subscribers;
+}
+
+constexpr auto StartSubscribers = FindSubscribers(HookStart);
+constexpr auto UpdateSubscribers = FindSubscribers(HookUpdate);
+constexpr auto DrawSubscribers = FindSubscribers(HookDraw);
+constexpr auto CollisionSubscribers = FindSubscribers(HookCollision);
 
+/**
+ * @brief Component that tells which scripts the entity has. The scripts themselves are stored as separate components.
+*/
+export class GameLogic
+{
+private:
 	/**
-	 * @brief Calls the draw section within the game logic scripts.
+	 * @brief Flags of the script types, bit index is the index in the script type table.
 	*/
-	[[nodiscard]] inline YmEventReturn DrawGraphicalItems()
+	unsigned int mScriptFlags = 0;
+
+#ifdef GAME
+	/**
+	 * @brief Calls the collision hook of both entities of every pair.
+	*/
+	static inline void DispatchContacts(std::vector<ContactPair> const& pairs, ScriptHooks const hook, float deltaTime, entt::registry& registry, EventWriter& events)
 	{
-		YmEventList eventList;
-		for (auto& script : mGameLogicScripts)
+		for (auto const& pair : pairs)
 		{
-			auto events = script->DrawItems();
-			if (events.has_value())
-				MergeYmEventLists(eventList, events.value());
+			auto first = (entt::entity)pair.mFirst;
+			auto second = (entt::entity)pair.mSecond;
 
-		}
-		if (eventList.size() > 0)
-			return eventList;
+			// Exits can refer to an entity whose body was removed during the step.
+			if (!registry.valid(first) || !registry.valid(second))
+				continue;
 
-		return {};
+			DispatchContact(hook, deltaTime, registry, first, second, events);
+			DispatchContact(hook, deltaTime, registry, second, first, events);
+		}
 	}
-#ifdef GAME
 
 	/**
-	* @brief Calls the collision event functions from game logic scripts.
+	 * @brief Calls the collision hook of the scripts of this entity. Entities without scripts are skipped.
 	*/
-	[[nodiscard]] inline YmEventReturn CollisionUpdates(PhysicalBody& physicalBody, float const& deltaTime, entt::registry& registry)
+	static inline void DispatchContact(ScriptHooks const hook, float deltaTime, entt::registry& registry, entt::entity thisEntity, entt::entity thatEntity, EventWriter& events)
 	{
-		auto thisEntity = (entt::entity)physicalBody.GetEntityId();
-		YmEventList eventList;
+		auto* gameLogic = registry.try_get<GameLogic>(thisEntity);
+		if (!gameLogic)
+			return;
 
-		// Going through the 3 different collision event functions
-		for (auto& [getItems, executeCollisionFunction] : collisionCalls)
+		auto collidingScripts = gameLogic->mScriptFlags & CollisionSubscribers.mFlags;
+		if (collidingScripts == 0)
+			return;
+
+		for (size_t i = 0; i < CollisionSubscribers.mCount; i++)
 		{
-			// Going throigh the list of items that collision events have happened with
-			for (auto& thatEntityRaw : getItems(physicalBody))
-			{
-				// Calling an appropriate collision event handling function
-				for (auto& script : mGameLogicScripts)
-				{
-					auto thatEntity = (entt::entity)thatEntityRaw;
-					if (registry.valid(thisEntity) && registry.valid(thatEntity))
-					{
-						auto events = executeCollisionFunction(script.get(), deltaTime, registry, thisEntity, thatEntity);
-
-						if (events.has_value())
-							MergeYmEventLists(eventList, events.value());
-					}
-				}
-			}
+			auto typeIndex = CollisionSubscribers.mTypes[i];
+			if ((collidingScripts & (1u << typeIndex)) && (ScriptTypes[typeIndex].mHooks & hook))
+				ScriptTypes[typeIndex].mCollide(hook, deltaTime, registry, thisEntity, thatEntity, events);
 		}
-
-		if (eventList.size() > 0)
-			return eventList;
-
-		return {};
 	}
 #endif // GAME
+public:
+	/**
+	 * @brief Calls the start section of every script in the registry.
+	*/
+	static inline void StartAll(float deltaTime, entt::registry& registry, EventWriter& events)
+	{
+		for (size_t i = 0; i < StartSubscribers.mCount; i++)
+			ScriptTypes[StartSubscribers.mTypes[i]].mStart(deltaTime, registry, events);
+	}
 
 	/**
-	 * @brief Adds a script to the collection based on the provided type.
-	 * @param type
+	 * @brief Calls the update section of every script in the registry, one type after the other.
 	*/
-	void AddScript(std::string const& type)
+	static inline void UpdateAll(float deltaTime, entt::registry& registry, EventWriter& events)
 	{
+		for (size_t i = 0; i < UpdateSubscribers.mCount; i++)
+			ScriptTypes[UpdateSubscribers.mTypes[i]].mUpdate(deltaTime, registry, events);
+	}
+
+	/**
+	 * @brief Calls the draw section of every script in the registry.
+	*/
+	static inline void DrawAll(entt::registry& registry, EventWriter& events)
+	{
+		for (size_t i = 0; i < DrawSubscribers.mCount; i++)
+			ScriptTypes[DrawSubscribers.mTypes[i]].mDraw(registry, events);
+	}
+
 #ifdef GAME
-		if (type == "PlayerMovement")
-		{
-			mGameLogicScripts.emplace_back(std::make_unique<PlayerMovement>());
-		}
-		else if (type == "GameFlowManager")
-		{
-			mGameLogicScripts.emplace_back(std::make_unique<GameFlowManager>());
-		}
-		else if (type == "ScoreTracker")
-		{
-			mGameLogicScripts.emplace_back(std::make_unique<PlayerScoreTracker>());
-		}
-		else if (type == "ScoreSubmission")
-		{
-			mGameLogicScripts.emplace_back(std::make_unique<ScoreSubmission>());
-		}
-		else if (type == "MainMenu")
-		{
-			mGameLogicScripts.emplace_back(std::make_unique<MainMenu>());
-		}
-		else if (type == "AIWalker")
-		{
-			mGameLogicScripts.emplace_back(std::make_unique<AIWalker>());
-		}
-		else if (type == "Reactive")
-		{
-			mGameLogicScripts.emplace_back(std::make_unique<ReactiveItem>());
-		}
+	/**
+	 * @brief Calls the collision event functions from the scripts of the entities in contact.
+	 * @note Exits go first, then enters and stays, the same order a single entity used to get them in.
+	*/
+	static inline void CollisionUpdates(ContactEvents const& contacts, float deltaTime, entt::registry& registry, EventWriter& events)
+	{
+		if (CollisionSubscribers.mCount == 0)
+			return;
+
+		DispatchContacts(contacts.mExited, HookCollisionExit, deltaTime, registry, events);
+		DispatchContacts(contacts.mEntered, HookCollisionEnter, deltaTime, registry, events);
+		DispatchContacts(contacts.mStayed, HookCollisionStay, deltaTime, registry, events);
+	}
 #endif // GAME
 
-#ifdef EDITOR
-		if (type == "EditorCamera")
+	/**
+	 * @brief Adds a script of the provided type to the entity.
+	 * @param registry
+	 * @param entity Owner of this component.
+	 * @param type Name of the script type.
+	*/
+	void AddScript(entt::registry& registry, entt::entity const& entity, std::string const& type)
+	{
+		auto hash = HashScriptName(type);
+		for (size_t i = 0; i < ScriptTypes.size(); i++)
 		{
-			mGameLogicScripts.emplace_back(std::make_unique<EditorCameraManager>());
-		}
+			// The hashes are only unique among the registered names, so a misspelled name could still share one.
+			if (ScriptTypes[i].mNameHash != hash || ScriptTypes[i].mName != type)
+				continue;
 
-		else if (type == "SceneEditor")
-		{
-			mGameLogicScripts.emplace_back(std::make_unique<SceneEditor>());
-		}
-#endif // EDITOR
-		else
-		{
-			Log(LGR_ERROR, std::format("Could not recognize script type \"{}\"", type));
+			if (mScriptFlags & (1u << i))
+			{
+				Log(LGR_WARNING, std::format("Entity already has script \"{}\", an entity can only have one script of each type", type));
+				return;
+			}
+
+			ScriptTypes[i].mAdd(registry, entity);
+			mScriptFlags |= 1u << i;
+			return;
 		}
+
+		Log(LGR_ERROR, std::format("Could not recognize script type \"{}\"", type));
 	}
 };
@@ -4,6 +4,7 @@ import <deque>;
 export module GameLogic.Base;
 export import YamaEvents;
 export import Logger;
+export import ProfilingZones;
 export import Input;
 export import Component.Transform;
 export import <optional>;
@@ -22,11 +23,12 @@ export class GameScriptBase
 {
 public:
 	// Has delta time for the situation if it was needed to do some velocity related things.
+	// Events are written into the engine's queue through the passed writer instead of being returned.
 
 	/**
 	* @brief Start function. Called once before the main game loop.
 	*/
-	[[nodiscard]] inline virtual YmEventReturn Start(float deltaTime, entt::registry& registry, entt::entity const& thisEntity) { return {}; }
+	inline virtual void Start(float deltaTime, entt::registry& registry, entt::entity const& thisEntity, EventWriter& events) {}
 
 	// If the amount of passed items gets out of the hand - make it into a struct
 	// Const as it (the entity) is not expected to be deleted or moved, but the data is free to  be edited (registry)
@@ -34,23 +36,23 @@ public:
 	/**
 	* @brief Update function called every game step at a locked intervals.
 	*/
-	[[nodiscard]] inline virtual YmEventReturn Update(float deltaTime, entt::registry& registry, entt::entity const& thisEntity) { return {}; }
+	inline virtual void Update(float deltaTime, entt::registry& registry, entt::entity const& thisEntity, EventWriter& events) {}
 
 #ifdef GAME
 	/**
 	* @brief Handle event when another physics body collides with the owner of this script.
 	*/
-	[[nodiscard]] inline virtual YmEventReturn OnCollisionEnter(float deltaTimem, entt::registry& registry, entt::entity const& thisEntity, entt::entity const& thatEntity) { return {}; }
+	inline virtual void OnCollisionEnter(float deltaTimem, entt::registry& registry, entt::entity const& thisEntity, entt::entity const& thatEntity, EventWriter& events) {}
 
 	/**
 	* @brief Handle event when another physics body stays in a collision with the owner of this script.
 	*/
-	[[nodiscard]] inline virtual YmEventReturn OnCollisionExit(float deltaTimem, entt::registry& registry, entt::entity const& thisEntity, entt::entity const& thatEntity) { return {}; }
+	inline virtual void OnCollisionExit(float deltaTimem, entt::registry& registry, entt::entity const& thisEntity, entt::entity const& thatEntity, EventWriter& events) {}
 
 	/**
 	* @brief Handle event when another physics body stops colliding with the owner of this script.
 	*/
-	[[nodiscard]] inline virtual YmEventReturn OnCollisionStay(float deltaTimem, entt::registry& registry, entt::entity const& thisEntity, entt::entity const& thatEntity) { return {}; }
+	inline virtual void OnCollisionStay(float deltaTimem, entt::registry& registry, entt::entity const& thisEntity, entt::entity const& thatEntity, EventWriter& events) {}
 #endif // GAME
 
 
@@ -64,5 +66,5 @@ public:
 	 * @brief The function that will be called outside of the game step section.
 	 * @note In order to provide graphical consistency GUI items should be called here.
 	*/
-	[[nodiscard]] inline virtual YmEventReturn DrawItems() { return {}; };
+	inline virtual void DrawItems(EventWriter& events) {}
 };
\ No newline at end of file
@@ -0,0 +1,356 @@
+export module GameTime;
+import <chrono>;
+import <array>;
+import <thread>;
+import <algorithm>;
+import <string_view>;
+import Logger;
+
+// Steady clock is used as the system clock can jump (e.g. when the system time is synced), which would either freeze the game or cause a huge lag spike.
+
+/**
+ * @brief How the frame rate limiter waits for the next frame.
+*/
+export enum class FrameLimiterMode
+{
+	Off,
+	Yield,
+	Sleep
+};
+
+/**
+ * @brief Convert the limiter name into the limiter mode.
+ * @param name Either "Off", "Yield" or "Sleep".
+ * @return Off if the name was not recognized.
+*/
+export inline FrameLimiterMode LimiterNameToMode(std::string_view const& name)
+{
+	if (name == "Sleep")
+		return FrameLimiterMode::Sleep;
+
+	if (name == "Yield")
+		return FrameLimiterMode::Yield;
+
+	if (name != "Off")
+		Log(LGR_WARNING, std::format("Could not recognize frame limiter \"{}\", frame limiter will be turned off", name));
+
+	return FrameLimiterMode::Off;
+}
+
+/**
+ * @brief Settings of the game time.
+ * @note Defaults are set in the main configuration file, while the scene files can override the fixed step, sub-step cap and time scale.
+*/
+export struct TimeSettings
+{
+	// Also works in 240, but just in case set it to 120 as it seems to be a healthy amount.
+
+	/**
+	 * @brief A fixed game and physics step.
+	*/
+	float mFixedStep = 1 / 120.f;
+
+	/**
+	 * @brief The maximum amount of fixed steps per frame.
+	 * @note Without the cap a slow frame produces more steps, which makes the next frame even slower (spiral of death).
+	*/
+	unsigned int mMaxSubsteps = 8;
+
+	/**
+	 * @brief Multiplier of the passing game time. 0.5 is slow motion, 2 is double speed.
+	*/
+	float mTimeScale = 1;
+
+	/**
+	 * @brief Frame rate that the limiter aims for. 0 means no limit.
+	*/
+	float mTargetFrameRate = 0;
+
+	/**
+	 * @brief How to wait for the next frame.
+	*/
+	FrameLimiterMode mLimiter = FrameLimiterMode::Off;
+};
+
+/**
+ * @brief Rolling history of the frame times.
+*/
+export class FrameHistory
+{
+public:
+	/**
+	 * @brief Amount of frames kept in the history.
+	*/
+	static constexpr size_t Capacity = 240;
+private:
+	/**
+	 * @brief Frame times in seconds, used as a ring buffer.
+	*/
+	std::array<float, Capacity> mFrameTimes{};
+
+	/**
+	 * @brief Index where the next frame time will be written.
+	*/
+	size_t mNextIndex = 0;
+
+	/**
+	 * @brief Amount of frames stored. Stops growing at the capacity.
+	*/
+	size_t mCount = 0;
+public:
+	/**
+	 * @brief Add a frame time, which replaces the oldest one if the history is full.
+	*/
+	inline void Push(float const frameTime) noexcept
+	{
+		mFrameTimes[mNextIndex] = frameTime;
+		mNextIndex = (mNextIndex + 1) % Capacity;
+		mCount = std::min(mCount + 1, Capacity);
+	}
+
+	/**
+	 * @brief Remove all of the frame times.
+	*/
+	inline void Clear() noexcept
+	{
+		mNextIndex = 0;
+		mCount = 0;
+	}
+
+	/**
+	 * @brief Get the amount of stored frame times.
+	*/
+	inline size_t GetCount() const noexcept
+	{
+		return mCount;
+	}
+
+	/**
+	 * @brief Get the average frame time in seconds.
+	*/
+	inline float GetAverage() const noexcept
+	{
+		if (mCount == 0)
+			return 0;
+
+		float total = 0;
+		for (size_t i = 0; i < mCount; i++)
+			total += mFrameTimes[i];
+		return total / mCount;
+	}
+
+	/**
+	 * @brief Get the slowest frame time in seconds.
+	*/
+	inline float GetWorst() const noexcept
+	{
+		if (mCount == 0)
+			return 0;
+
+		return *std::max_element(mFrameTimes.begin(), mFrameTimes.begin() + mCount);
+	}
+
+	/**
+	 * @brief Get the frame time by its age, 0 being the latest frame.
+	*/
+	inline float GetFrame(size_t const age) const noexcept
+	{
+		if (age >= mCount)
+			return 0;
+
+		return mFrameTimes[(mNextIndex + Capacity - 1 - age) % Capacity];
+	}
+};
+
+/**
+ * @brief Keeps track of the real and the game time, and decides how many fixed steps have to be done every frame.
+*/
+export class GameTime
+{
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	/**
+	 * @brief Currently used settings.
+	*/
+	TimeSettings mSettings;
+
+	/**
+	 * @brief Start of the current frame.
+	*/
+	Clock::time_point mFrameStart = Clock::now();
+
+	/**
+	 * @brief Accumulated game time that has not been simulated yet.
+	*/
+	float mLag = 0;
+
+	/**
+	 * @brief Amount of fixed steps done within the current frame.
+	*/
+	unsigned int mStepsThisFrame = 0;
+
+	/**
+	 * @brief Total game time that was thrown away because of the sub-step cap.
+	*/
+	float mDroppedTime = 0;
+
+	/**
+	 * @brief Real frame times.
+	*/
+	FrameHistory mHistory;
+public:
+	/**
+	 * @brief Highest allowed time scale. Above it the sub-step cap would drop most of the game time anyway.
+	*/
+	static constexpr float MaxTimeScale = 10;
+
+	/**
+	 * @brief Apply new settings and restart the clock.
+	 * @note Should be called before the game loop of every scene.
+	*/
+	inline void Reset(TimeSettings const& settings)
+	{
+		mSettings = settings;
+
+		if (mSettings.mFixedStep <= 0)
+		{
+			Log(LGR_ERROR, std::format("Fixed step has to be positive, but was {}. The default will be used.", mSettings.mFixedStep));
+			mSettings.mFixedStep = TimeSettings().mFixedStep;
+		}
+
+		mSettings.mMaxSubsteps = std::max(1u, mSettings.mMaxSubsteps);
+		// The scale comes from the configuration or the scene file, so it goes through the same validation.
+		SetTimeScale(settings.mTimeScale);
+		mLag = 0;
+		mStepsThisFrame = 0;
+		mHistory.Clear();
+		mFrameStart = Clock::now();
+	}
+
+	/**
+	 * @brief Start a new frame.
+	 * @return Real time in seconds that the previous frame took.
+	*/
+	inline float Tick()
+	{
+		auto currentTime = Clock::now();
+		std::chrono::duration<float> elapsedTime = currentTime - mFrameStart;
+		mFrameStart = currentTime;
+		mStepsThisFrame = 0;
+
+		mHistory.Push(elapsedTime.count());
+		return elapsedTime.count();
+	}
+
+	/**
+	 * @brief Add real time to the game time, applying the time scale and the sub-step cap.
+	 * @param realSeconds
+	*/
+	inline void Accumulate(float const realSeconds)
+	{
+		mLag += realSeconds * mSettings.mTimeScale;
+
+		auto const maxLag = mSettings.mFixedStep * mSettings.mMaxSubsteps;
+		if (mLag > maxLag)
+		{
+			mDroppedTime += mLag - maxLag;
+			mLag = maxLag;
+		}
+	}
+
+	/**
+	 * @brief Add exactly one fixed step of the game time, so that the runs are the same regardless of how fast the machine is.
+	*/
+	inline void AccumulateFixedStep()
+	{
+		mLag += mSettings.mFixedStep;
+	}
+
+	/**
+	 * @brief Take one fixed step out of the accumulated game time.
+	 * @return False if there is not enough time accumulated or the sub-step cap is reached.
+	*/
+	inline bool ConsumeFixedStep()
+	{
+		if (mLag < mSettings.mFixedStep || mStepsThisFrame >= mSettings.mMaxSubsteps)
+			return false;
+
+		mLag -= mSettings.mFixedStep;
+		mStepsThisFrame++;
+		return true;
+	}
+
+	/**
+	 * @brief Get the interpolation state between the previous and the current fixed step.
+	*/
+	inline float GetAlpha() const noexcept
+	{
+		return std::min(1.f, mLag / mSettings.mFixedStep);
+	}
+
+	/**
+	 * @brief Get the fixed step in seconds.
+	*/
+	inline float GetFixedStep() const noexcept
+	{
+		return mSettings.mFixedStep;
+	}
+
+	/**
+	 * @brief Get the amount of fixed steps done in the current frame.
+	*/
+	inline unsigned int GetStepsThisFrame() const noexcept
+	{
+		return mStepsThisFrame;
+	}
+
+	/**
+	 * @brief Get the total game time that was skipped due to the sub-step cap.
+	*/
+	inline float GetDroppedTime() const noexcept
+	{
+		return mDroppedTime;
+	}
+
+	/**
+	 * @brief Change the time scale.
+	 * @param timeScale Clamped between 0 (paused) and MaxTimeScale.
+	*/
+	inline void SetTimeScale(float const timeScale)
+	{
+		mSettings.mTimeScale = std::clamp(timeScale, 0.f, MaxTimeScale);
+		if (mSettings.mTimeScale != timeScale)
+			Log(LGR_WARNING, std::format("Time scale {} is outside of [0, {}], {} will be used", timeScale, MaxTimeScale, mSettings.mTimeScale));
+	}
+
+	/**
+	 * @brief Get the rolling history of the frame times.
+	*/
+	inline FrameHistory const& GetHistory() const noexcept
+	{
+		return mHistory;
+	}
+
+	/**
+	 * @brief Wait until the target frame duration has passed since the start of the frame.
+	 * @note Sleeping is not precise, so the last couple of milliseconds are yielded.
+	*/
+	inline void LimitFrameRate() const
+	{
+		if (mSettings.mLimiter == FrameLimiterMode::Off || mSettings.mTargetFrameRate <= 0)
+			return;
+
+		auto const frameEnd = mFrameStart + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(1.f / mSettings.mTargetFrameRate));
+		constexpr auto sleepMargin = std::chrono::milliseconds(2);
+
+		if (mSettings.mLimiter == FrameLimiterMode::Sleep)
+		{
+			while (frameEnd - Clock::now() > sleepMargin)
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		while (Clock::now() < frameEnd)
+			std::this_thread::yield();
+	}
+};
@@ -7,8 +7,10 @@ import "driverChoice.h";
 import Component.Transform;
 import Component.GraphicsComponents;
 import <optional>;
+import <vector>;
 import "IrrAssimp/IrrAssimp.h";
 import YaMath;
+import RunSettings;
 using namespace irr;
 using namespace video;
 using namespace scene;
@@ -41,6 +43,12 @@ private:
 	*/
 	std::unique_ptr<IrrAssimp> mAssimpLoader;
 
+	/**
+	 * @brief Flag for running without a window.
+	 * @note Scenes are still drawn (if the driver supports it), but are never presented.
+	*/
+	bool mHeadless = false;
+
 	/**
 	 * @brief Window title.
 	*/
@@ -57,20 +65,29 @@ private:
 		;
 public:
 
-	GraphicsWrapper(irr::u32 const& width, irr::u32 const& height, void* eventReceiverRaw = nullptr ,bool askForDriver = false)
+	GraphicsWrapper(irr::u32 const& width, irr::u32 const& height, void* eventReceiverRaw = nullptr ,bool askForDriver = false, HeadlessDriver const headlessDriver = HeadlessDriver::None)
 	{
 		auto eventReceiver =(irr::IEventReceiver*)eventReceiverRaw;
 		Log(Verbosity::LGR_INFO, "Initializing graphics engine...");
+		mHeadless = headlessDriver != HeadlessDriver::None;
+
 		auto driver = askForDriver ? driverChoiceConsole() : video::E_DRIVER_TYPE::EDT_DIRECT3D9;
+		if (mHeadless)
+			driver = headlessDriver == HeadlessDriver::Software ? EDT_BURNINGSVIDEO : EDT_NULL;
 		AssertNotEqual(driver, EDT_COUNT, "A non-valid driver has been selected");
 
 		irr::SIrrlichtCreationParameters param;
 		param.DriverType = driver;
 		param.EventReceiver = eventReceiver;
-		param.Stencilbuffer = true;
+		param.Stencilbuffer = !mHeadless;
 		param.WindowSize = core::dimension2d<u32>(width, height);
 		param.Bits = 32;
-		param.AntiAlias = 16;
+		param.AntiAlias = mHeadless ? 0 : 16;
+
+		// Console device does not need a windowing system, so it can be run on machines without display.
+		if (mHeadless)
+			param.DeviceType = EIDT_CONSOLE;
+
 		mDevice = irr::createDeviceEx(param);
 		AssertNotNull(mDevice, "Yama engine was unable to create the graphic's mDevice");
 
@@ -118,7 +135,17 @@ public:
 	*/
 	inline void EndScene()
 	{
-		mVideDriver->endScene();
+		// Ending the scene presents it, which the console device would do by printing the frame as text.
+		if (!mHeadless)
+			mVideDriver->endScene();
+	}
+
+	/**
+	 * @brief Check if the graphics are running without a window.
+	*/
+	inline bool IsHeadless() const noexcept
+	{
+		return mHeadless;
 	}
 
 
@@ -197,6 +224,51 @@ public:
 		return MeshComp(node, meshPath, texturePath);
 	}
 
+#ifdef GAME
+	/**
+	 * @brief Get the triangles of the first frame of a mesh, e.g. to build a collider from them.
+	 * @param meshPath
+	 * @param vertices Filled with the vertex positions of every mesh buffer.
+	 * @param indices Filled with three indices into the vertices per triangle.
+	 * @return False if the mesh could not be loaded.
+	*/
+	inline bool GetMeshGeometry(std::string const& meshPath, std::vector<yamath::Vec3D>& vertices, std::vector<int>& indices)
+	{
+		auto mesh = mAssimpLoader->getMesh(meshPath.c_str());
+		if (!mesh)
+			return false;
+
+		// Frame 0 is the bind pose of the animated meshes.
+		auto frame = mesh->getMesh(0);
+		for (u32 i = 0; i < frame->getMeshBufferCount(); i++)
+		{
+			auto buffer = frame->getMeshBuffer(i);
+			// Buffers have their own vertices, so their indices are moved past the vertices of the previous buffers.
+			auto firstVertex = (int)vertices.size();
+			for (u32 vertex = 0; vertex < buffer->getVertexCount(); vertex++)
+			{
+				auto const& position = buffer->getPosition(vertex);
+				vertices.push_back({ position.X, position.Y, position.Z });
+			}
+
+			auto indexCount = buffer->getIndexCount();
+			if (buffer->getIndexType() == EIT_16BIT)
+			{
+				auto bufferIndices = (u16 const*)buffer->getIndices();
+				for (u32 index = 0; index < indexCount; index++)
+					indices.push_back(firstVertex + bufferIndices[index]);
+			}
+			else
+			{
+				auto bufferIndices = (u32 const*)buffer->getIndices();
+				for (u32 index = 0; index < indexCount; index++)
+					indices.push_back(firstVertex + (int)bufferIndices[index]);
+			}
+		}
+		return true;
+	}
+#endif // GAME
+
 	/**
 	 * @brief Get number of primitives that are currently drawn from the graphics engine internals.
 	*/
@@ -207,9 +279,10 @@ public:
 
 	/**
 	 * @brief Update the mesh node with data coming from game scripts or physics engine.
+	 * @note In the game the rotation is interpolated beforehand, as it is done for all of the moved entities in a batch.
 	*/
 #ifdef GAME
-	inline void UpdateMeshNode(Transform const& oldState, Transform const& newState, MeshComp& meshComp, float const& alpha)
+	inline void UpdateMeshNode(PreviousTransform const& oldState, Transform const& newState, yamath::Quat const& currentRotation, MeshComp& meshComp, float const& alpha)
 #else
 	inline void UpdateMeshNode(Transform const& currentState, MeshComp& meshComp)
 #endif // GAME
@@ -259,11 +332,11 @@ public:
 #ifdef GAME
 		// Maybe make it into a macro since this is used in other components as well
 		auto currentPos = Lerp(newState.mPosition, oldState.mPosition, alpha);
-		auto currentRot = Lerp(newState.mRotation, oldState.mRotation, alpha);
+		auto currentRot = ToEuler(currentRotation);
 		auto currentScale = Lerp(newState.mScale, oldState.mScale, alpha);
 #else
 		auto& currentPos = currentState.mPosition;
-		auto& currentRot = currentState.mRotation;
+		auto currentRot = ToEuler(currentState.mRotation);
 		auto& currentScale = currentState.mScale;
 
 #endif // GAME
@@ -322,10 +395,11 @@ public:
 	 * @brief Update the camera object with the data coming from game scripts or physics engine.
 	 * @param oldState
 	 * @param newState
+	 * @param currentRotation Interpolated rotation.
 	 * @param camera
 	 * @param alpha
 	*/
-	inline void UpdateCameraNode(Transform const& oldState, Transform const& newState, CameraComponent& camera, float const& alpha)
+	inline void UpdateCameraNode(PreviousTransform const& oldState, Transform const& newState, yamath::Quat const& currentRotation, CameraComponent& camera, float const& alpha)
 	{
 		auto currentPos = Lerp(newState.mPosition, oldState.mPosition, alpha);
 		auto currentScale = Lerp(newState.mScale, oldState.mScale, alpha);
@@ -337,7 +411,7 @@ public:
 		// When using an Irrlciht FPS camera, the rotation is set internally.
 		if(camera.mCamType != "FPS")
 		{
-			auto currentRot = Lerp(newState.mRotation, oldState.mRotation, alpha);
+			auto currentRot = ToEuler(currentRotation);
 			camera.mSceneNode->setRotation({ currentRot.X, currentRot.Y, currentRot.Z });
 		}
 
@@ -360,13 +434,14 @@ public:
 	 * @brief Update the light object with the data coming from either game scripts or physics engine.
 	 * @param oldState
 	 * @param newState
+	 * @param currentRotation Interpolated rotation.
 	 * @param light
 	 * @param alpha
 	*/
-	inline void UpdateLightNode(Transform const& oldState, Transform const& newState, LightComponent& light, float const& alpha)
+	inline void UpdateLightNode(PreviousTransform const& oldState, Transform const& newState, yamath::Quat const& currentRotation, LightComponent& light, float const& alpha)
 	{
 		auto currentPos = Lerp(newState.mPosition, oldState.mPosition, alpha);
-		auto currentRot = Lerp(newState.mRotation, oldState.mRotation, alpha);
+		auto currentRot = ToEuler(currentRotation);
 		auto currentScale = Lerp(newState.mScale, oldState.mScale, alpha);
 
 		light.mLightNode->setPosition({ currentPos.X, currentPos.Y, currentPos.Z });
@@ -385,7 +460,8 @@ public:
 	inline void UpdateCameraNode(Transform const& transform, CameraComponent& camera)
 	{
 		camera.mSceneNode->setPosition({ transform.mPosition.X,  transform.mPosition.Y,  transform.mPosition.Z });
-		camera.mSceneNode->setRotation({ transform.mRotation.X, transform.mRotation.Y, transform.mRotation.Z });
+		auto rotation = ToEuler(transform.mRotation);
+		camera.mSceneNode->setRotation({ rotation.X, rotation.Y, rotation.Z });
 		camera.mSceneNode->setScale({ transform.mScale.X, transform.mScale.Y, transform.mScale.Z });
 		camera.mSceneNode->updateAbsolutePosition();
 		auto children = camera.mSceneNode->getChildren();
@@ -4,6 +4,8 @@ import Logger;
 import "irrlicht.h";
 import <unordered_set>;
 import <tuple>;
+import <vector>;
+import <algorithm>;
 
 // Already used:
 // Gainput - mouse support was great, couldn't get consistant data for keyboard inputs;
@@ -219,6 +221,55 @@ namespace Input
 	*/
 	float mmbScroll = 0;
 
+	/**
+	 * @brief Flag for ignoring the device events, as the input is coming from a replay.
+	*/
+	bool replaying = false;
+
+	/**
+	 * @brief Snapshot of the whole input state.
+	 * @note Used for recording and replaying the sessions.
+	*/
+	export struct InputState
+	{
+		/**
+		 * @brief Key codes of the pressed keys, sorted so that the same state always looks the same.
+		*/
+		std::vector<int> mPressedKeys;
+
+		/**
+		 * @brief Flag for clicked left mouse button.
+		*/
+		bool mLMB = false;
+
+		/**
+		 * @brief Flag for clicked right mouse button.
+		*/
+		bool mRMB = false;
+
+		/**
+		 * @brief Flag for clicked middle mouse button.
+		*/
+		bool mMMB = false;
+
+		/**
+		 * @brief Relative Mouse position on X axis.
+		*/
+		float mMouseXRel = 0;
+
+		/**
+		 * @brief Relative Mouse position on Y axis.
+		*/
+		float mMouseYRel = 0;
+
+		/**
+		 * @brief Mouse Scroll wheel moved amount.
+		*/
+		float mScroll = 0;
+
+		bool operator==(InputState const&) const = default;
+	};
+
 	/**
 	 * @brief Custom input event handler for Irrlicht.
 	*/
@@ -294,6 +345,10 @@ namespace Input
 			if(mAdditionalHandler)
 				mAdditionalHandler->OnEvent(event);
 
+			// The replayed state would get mixed with whatever the device sends.
+			if (replaying)
+				return false;
+
 			switch (event.EventType)
 			{
 				using enum irr::EEVENT_TYPE;
@@ -479,6 +534,53 @@ namespace Input
 			handler.LockCursor(locked);
 		}
 
+		/**
+		 * @brief Get the current state of all of the inputs.
+		 * @return
+		*/
+		inline InputState CaptureState() const
+		{
+			InputState state;
+			for (auto const& key : pressedKeys)
+				state.mPressedKeys.emplace_back((int)key);
+			std::sort(state.mPressedKeys.begin(), state.mPressedKeys.end());
+
+			state.mLMB = lmbClicked;
+			state.mRMB = rmbClicked;
+			state.mMMB = mmbClicked;
+			state.mMouseXRel = mouseXRel;
+			state.mMouseYRel = mouseYRel;
+			state.mScroll = mmbScroll;
+			return state;
+		}
+
+		/**
+		 * @brief Overwrite the state of all of the inputs.
+		 * @param state
+		*/
+		inline void ApplyState(InputState const& state)
+		{
+			pressedKeys.clear();
+			for (auto const& key : state.mPressedKeys)
+				pressedKeys.insert((Keys)key);
+
+			lmbClicked = state.mLMB;
+			rmbClicked = state.mRMB;
+			mmbClicked = state.mMMB;
+			mouseXRel = state.mMouseXRel;
+			mouseYRel = state.mMouseYRel;
+			mmbScroll = state.mScroll;
+		}
+
+		/**
+		 * @brief Change whether the input comes from a replay instead of the devices.
+		 * @param replay
+		*/
+		inline void SetReplaying(bool replay)
+		{
+			replaying = replay;
+		}
+
 		/**
 		 * @brief Change cursor visibility state.
 		 * @param visible
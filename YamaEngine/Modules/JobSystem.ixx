@@ -0,0 +1,332 @@
+export module JobSystem;
+import <thread>;
+import <vector>;
+import <deque>;
+import <mutex>;
+import <condition_variable>;
+import <functional>;
+import <atomic>;
+import <memory>;
+import <algorithm>;
+import Logger;
+import ProfilingZones;
+
+// Every thread owns a queue, it pushes and pops its own jobs from the back (so the most recent and cache warm jobs are done first),
+// while the threads that ran out of work steal from the front of other queues.
+// A mutex per queue is used instead of a lock-free deque, as the amount of jobs per frame is small and the locks are rarely contested.
+
+/**
+ * @brief Function that will be run by the job system.
+*/
+export typedef std::function<void()> Job;
+
+/**
+ * @brief Counter of unfinished jobs. Used to wait for a group of jobs to finish.
+*/
+export typedef std::atomic<int> JobCounter;
+
+/**
+ * @brief Index of the queue that belongs to the current thread. Main thread is always 0.
+*/
+thread_local unsigned int tQueueIndex = 0;
+
+/**
+ * @brief Queue of jobs owned by a single thread.
+*/
+class WorkQueue
+{
+private:
+	/**
+	 * @brief Pending jobs.
+	*/
+	std::deque<Job> mJobs;
+
+	/**
+	 * @brief Guard for the job collection.
+	*/
+	std::mutex mMutex;
+public:
+	/**
+	 * @brief Add a job to the back of the queue.
+	*/
+	inline void Push(Job&& job)
+	{
+		std::lock_guard lock(mMutex);
+		mJobs.emplace_back(std::move(job));
+	}
+
+	/**
+	 * @brief Take the newest job. Meant for the owner of the queue.
+	 * @return False if the queue was empty.
+	*/
+	inline bool PopBack(Job& job)
+	{
+		std::lock_guard lock(mMutex);
+		if (mJobs.empty())
+			return false;
+
+		job = std::move(mJobs.back());
+		mJobs.pop_back();
+		return true;
+	}
+
+	/**
+	 * @brief Take the oldest job. Meant for the threads that are stealing the work.
+	 * @return False if the queue was empty.
+	*/
+	inline bool StealFront(Job& job)
+	{
+		std::lock_guard lock(mMutex);
+		if (mJobs.empty())
+			return false;
+
+		job = std::move(mJobs.front());
+		mJobs.pop_front();
+		return true;
+	}
+};
+
+/**
+ * @brief Engine wide work-stealing thread pool.
+ * @note Main thread does not sleep while waiting for jobs, instead it helps to finish them.
+*/
+export class JobSystem
+{
+private:
+	/**
+	 * @brief Queues for every thread. Index 0 belongs to the main thread.
+	*/
+	std::vector<std::unique_ptr<WorkQueue>> mQueues;
+
+	/**
+	 * @brief Worker threads.
+	*/
+	std::vector<std::thread> mWorkers;
+
+	/**
+	 * @brief Flag for keeping the workers alive.
+	*/
+	std::atomic<bool> mRunning = false;
+
+	/**
+	 * @brief Amount of jobs that are in the queues, but not taken yet.
+	 * @note Used for putting the workers to sleep when there is nothing to do.
+	*/
+	std::atomic<int> mQueuedJobs = 0;
+
+	/**
+	 * @brief Mutex for the sleeping workers.
+	*/
+	std::mutex mSleepMutex;
+
+	/**
+	 * @brief Used to wake up the workers when new jobs are added.
+	*/
+	std::condition_variable mWakeUp;
+private:
+	JobSystem() = default;
+
+	/**
+	 * @brief Try to get a job, first from the own queue and then from the others.
+	 * @param queueIndex Queue of the calling thread.
+	 * @param job Taken job.
+	 * @return False if there were no jobs to be taken.
+	*/
+	inline bool TryGetJob(unsigned int const queueIndex, Job& job)
+	{
+		if (mQueues[queueIndex]->PopBack(job))
+		{
+			mQueuedJobs--;
+			return true;
+		}
+
+		auto const queueCount = mQueues.size();
+		for (size_t i = 1; i < queueCount; i++)
+		{
+			if (mQueues[(queueIndex + i) % queueCount]->StealFront(job))
+			{
+				mQueuedJobs--;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	/**
+	 * @brief Worker thread loop.
+	 * @param queueIndex Queue that is owned by the worker.
+	*/
+	void WorkerLoop(unsigned int const queueIndex)
+	{
+		tQueueIndex = queueIndex;
+		yaprfl::SetThreadName(std::format("Worker {}", queueIndex));
+		Job job;
+
+		while (mRunning)
+		{
+			if (TryGetJob(queueIndex, job))
+			{
+				job();
+				job = nullptr;
+				continue;
+			}
+
+			std::unique_lock lock(mSleepMutex);
+			mWakeUp.wait(lock, [this]() { return mQueuedJobs > 0 || !mRunning; });
+		}
+	}
+
+public:
+	JobSystem(JobSystem const&) = delete;
+	void operator=(JobSystem const&) = delete;
+
+	~JobSystem()
+	{
+		Shutdown();
+	}
+
+	/**
+	 * @brief Get the job system.
+	 * @return
+	*/
+	inline static JobSystem& Instance()
+	{
+		static JobSystem instance;
+		return instance;
+	}
+
+	/**
+	 * @brief Start the worker threads.
+	 * @param workerCount Amount of threads besides the main one. Negative value will use one less than the available hardware threads.
+	*/
+	void Init(int workerCount = -1)
+	{
+		if (mRunning)
+			return;
+
+		if (workerCount < 0)
+			workerCount = std::max(0, (int)std::thread::hardware_concurrency() - 1);
+
+		mQueues.clear();
+		for (int i = 0; i <= workerCount; i++)
+			mQueues.emplace_back(std::make_unique<WorkQueue>());
+
+		mRunning = true;
+		for (int i = 1; i <= workerCount; i++)
+			mWorkers.emplace_back(&JobSystem::WorkerLoop, this, i);
+
+		Log(LGR_INFO, std::format("Job system started with {} worker threads", workerCount));
+	}
+
+	/**
+	 * @brief Stop and join the worker threads.
+	*/
+	void Shutdown()
+	{
+		if (!mRunning)
+			return;
+
+		{
+			std::lock_guard lock(mSleepMutex);
+			mRunning = false;
+		}
+		mWakeUp.notify_all();
+
+		for (auto& worker : mWorkers)
+			worker.join();
+
+		mWorkers.clear();
+		mQueues.clear();
+	}
+
+	/**
+	 * @brief Get the amount of threads that can run the jobs, including the main thread.
+	*/
+	inline unsigned int GetThreadCount() const noexcept
+	{
+		return (unsigned int)std::max<size_t>(1, mQueues.size());
+	}
+
+	/**
+	 * @brief Get the index of the calling thread. Main thread is 0, workers go from 1 to thread count - 1.
+	*/
+	inline static unsigned int GetThreadIndex() noexcept
+	{
+		return tQueueIndex;
+	}
+
+	/**
+	 * @brief Add a job to the queue of the calling thread.
+	 * @param job
+	 * @param counter Counter that is increased now and decreased when the job is finished.
+	*/
+	void Submit(Job job, JobCounter& counter)
+	{
+		counter++;
+
+		// Not initialized, so there is no one else to do the work.
+		if (mQueues.empty())
+		{
+			job();
+			counter--;
+			return;
+		}
+
+		mQueues[tQueueIndex]->Push([job = std::move(job), &counter]()
+								   {
+									   job();
+									   counter--;
+								   });
+
+		{
+			std::lock_guard lock(mSleepMutex);
+			mQueuedJobs++;
+		}
+		mWakeUp.notify_one();
+	}
+
+	/**
+	 * @brief Wait for the jobs to finish, while helping to run them.
+	 * @param counter
+	*/
+	void Wait(JobCounter const& counter)
+	{
+		Job job;
+		while (counter > 0)
+		{
+			if (!mQueues.empty() && TryGetJob(tQueueIndex, job))
+			{
+				job();
+				job = nullptr;
+			}
+			else
+			{
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	/**
+	 * @brief Split a range into batches and run them in parallel. Returns when all of the batches are done.
+	 * @param count Size of the range.
+	 * @param batchSize Minimal amount of items per job.
+	 * @param function Called with [start, end) of the batch.
+	*/
+	void ParallelFor(size_t const count, size_t batchSize, std::function<void(size_t, size_t)> const& function)
+	{
+		if (count == 0)
+			return;
+
+		batchSize = std::max<size_t>(1, std::max(batchSize, count / (GetThreadCount() * 4)));
+
+		JobCounter counter = 0;
+		for (size_t start = 0; start < count; start += batchSize)
+		{
+			auto end = std::min(count, start + batchSize);
+			Submit([&function, start, end]() { function(start, end); }, counter);
+		}
+
+		Wait(counter);
+	}
+};
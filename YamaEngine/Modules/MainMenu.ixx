@@ -39,7 +39,7 @@ public:
 		}
 	}
 
-	[[nodiscard]] inline YmEventReturn Start(float deltaTime, entt::registry& registry, entt::entity const& thisEntity) override
+	inline void Start(float deltaTime, entt::registry& registry, entt::entity const& thisEntity, EventWriter& events) override
 	{
 		// Disabled async call as for some reason it would get the issue mentioned in the SetTopScore() even with the error catching. Occurs in _CONSTEXPR20_CONTAINER void _Container_base12::_Orphan_all_unlocked_v3() noexcept
 		//handle = std::async(&MainMenu::SetTopScore, this);
@@ -50,16 +50,13 @@ public:
 		// There was something about using /MD for linker flags, but this project can't use it as it linked against mixed - static and dynamic libraries.
 
 		SetTopScore();
-		YmEventList events;
-		events.emplace_back(YmEventTypes::CursorState, new int (0));
-
-		return events;
+		events.Emit(CursorStateEvent{ 0 });
 	}
 
-	[[nodiscard]] inline YmEventReturn DrawItems() override
+	inline void DrawItems(EventWriter& events) override
 	{
 		GUI::Instance().DisplayHighScores(mHighscore, mHasFinishedConnecting);
-		return GUI::Instance().TitleScreenText();
+		GUI::Instance().TitleScreenText(events);
 	}
 
 	~MainMenu()
@@ -18,6 +18,7 @@ import YamaEvents;
 
 #ifdef GAME
 import HighScoreEntity;
+import Component.Physics;
 import <vector>;
 import <algorithm>;
 #endif // GAME
@@ -27,9 +28,6 @@ import "EditorComponents.h";
 import <filesystem>;
 
 import SceneObject;
-// The bool 0 - delete, 1 - add
-// As long as it doesn't get any more complex it should be an okay to use a tuple instead of a struct
-export typedef std::tuple<entt::entity, EditorComponentTypes, bool> Modification;
 
 namespace fs = std::filesystem;
 #endif // EDITOR
@@ -53,7 +51,7 @@ private:
 	 * @brief Handler for the GUI.
 	 * @note mainly to manage the GUI. For engine use.
 	*/
-	IIMGUIHandle* mGUI;
+	IIMGUIHandle* mGUI = nullptr;
 
 	/**
 	 * @brief Flag for checking if user decided to exit via GUI.
@@ -137,7 +135,7 @@ private:
 	/**
 	 * @brief Display the buttons for various editor components.
 	 * @param entity
-	 * @param addedItems
+	 * @param events
 	 * @param meshComp
 	 * @param colliderComp
 	 * @param scriptsComp
@@ -146,56 +144,42 @@ private:
 	 * @param lightComp
 	 * @param beaconNavComp
 	*/
-	void inline PopulateComponentButtons(entt::entity const& entity, YmEventList& addedItems, GraphicsEditorComponent* meshComp, PhysicsEditorComponent* colliderComp, ScriptsEditorComponent* scriptsComp, AudioEditorComponent* audioComp, CameraEditorComponent* cameraComp, LightEditorComponent* lightComp, BeaconNavEditorComponent* beaconNavComp)
+	void inline PopulateComponentButtons(entt::entity const& entity, EventWriter& events, GraphicsEditorComponent* meshComp, PhysicsEditorComponent* colliderComp, ScriptsEditorComponent* scriptsComp, AudioEditorComponent* audioComp, CameraEditorComponent* cameraComp, LightEditorComponent* lightComp, BeaconNavEditorComponent* beaconNavComp)
 	{
 		// Ideally this would be populated by some list that is filled based on reflection (get all the children of editor component class)
 		if (!meshComp && ImGui::Button("Add mesh"))
 		{
-			addedItems.emplace_back(
-				EditorChange,
-				new Modification(entity, EditorComponentTypes::EditorMeshType, true));
+			events.Emit(EditorChangeEvent{ entity, EditorComponentTypes::EditorMeshType, true });
 		}
 
 		if (!colliderComp && ImGui::Button("Add cube collider"))
 		{
-			addedItems.emplace_back(
-				EditorChange,
-				new Modification(entity, EditorComponentTypes::EditorColliderType, true));
+			events.Emit(EditorChangeEvent{ entity, EditorComponentTypes::EditorColliderType, true });
 		}
 
 		if (!scriptsComp && ImGui::Button("Add Scripts"))
 		{
-			addedItems.emplace_back(
-				EditorChange,
-				new Modification(entity, EditorComponentTypes::EditorGameScriptType, true));
+			events.Emit(EditorChangeEvent{ entity, EditorComponentTypes::EditorGameScriptType, true });
 		}
 
 		if (!audioComp && ImGui::Button("Add Audio"))
 		{
-			addedItems.emplace_back(
-				EditorChange,
-				new Modification(entity, EditorComponentTypes::EditorAudioSourcesType, true));
+			events.Emit(EditorChangeEvent{ entity, EditorComponentTypes::EditorAudioSourcesType, true });
 		}
 
 		if (!cameraComp && ImGui::Button("Add FPS Camera"))
 		{
-			addedItems.emplace_back(
-				EditorChange,
-				new Modification(entity, EditorComponentTypes::EditorCameraType, true));
+			events.Emit(EditorChangeEvent{ entity, EditorComponentTypes::EditorCameraType, true });
 		}
 
 		if (!lightComp && ImGui::Button("Add Light"))
 		{
-			addedItems.emplace_back(
-				EditorChange,
-				new Modification(entity, EditorComponentTypes::EditorLightType, true));
+			events.Emit(EditorChangeEvent{ entity, EditorComponentTypes::EditorLightType, true });
 		}
 
 		if (!beaconNavComp && ImGui::Button("Add beacon navigation"))
 		{
-			addedItems.emplace_back(
-				EditorChange,
-				new Modification(entity, EditorComponentTypes::EditorPathNavType, true));
+			events.Emit(EditorChangeEvent{ entity, EditorComponentTypes::EditorPathNavType, true });
 		}
 	}
 
@@ -275,8 +259,12 @@ private:
 	*/
 	inline void DisplayMenuCollider(PhysicsEditorComponent* comp)
 	{
-		//InputString(mColliderType, "Collider type");
+		InputString(comp->mColliderType, "Collider type");
 		ImGui::InputFloat("Mass", &comp->mMass);
+		InputString(comp->mLayer, "Collision layer");
+		ImGui::Checkbox("Trigger", &comp->mTrigger);
+		ImGui::Checkbox("Kinematic", &comp->mKinematic);
+		ImGui::Checkbox("Merge static collider", &comp->mMerge);
 
 		ImGui::Text("Offset");
 		ImGui::Indent();
@@ -285,12 +273,34 @@ private:
 		ImGui::InputFloat("Z##o", &comp->mOffsets.Z);
 		ImGui::Unindent();
 
-		ImGui::Text("Extents");
-		ImGui::Indent();
-		ImGui::InputFloat("X##e", &comp->mExtents.X);
-		ImGui::InputFloat("Y##e", &comp->mExtents.Y);
-		ImGui::InputFloat("Z##e", &comp->mExtents.Z);
-		ImGui::Unindent();
+		// Only the parameters of the picked shape are shown, the compound children can only be edited in the scene file.
+		if (comp->mColliderType == "Box")
+		{
+			ImGui::Text("Extents");
+			ImGui::Indent();
+			ImGui::InputFloat("X##e", &comp->mExtents.X);
+			ImGui::InputFloat("Y##e", &comp->mExtents.Y);
+			ImGui::InputFloat("Z##e", &comp->mExtents.Z);
+			ImGui::Unindent();
+		}
+
+		if (comp->mColliderType == "Sphere" || comp->mColliderType == "Capsule")
+			ImGui::InputFloat("Radius", &comp->mRadius);
+
+		if (comp->mColliderType == "Capsule")
+			ImGui::InputFloat("Height", &comp->mHeight);
+
+		if (comp->mColliderType == "ConvexHull" || comp->mColliderType == "TriangleMesh")
+		{
+			InputString(comp->mMeshPath, "Mesh path");
+
+			ImGui::Text("Scale");
+			ImGui::Indent();
+			ImGui::InputFloat("X##cs", &comp->mScale.X);
+			ImGui::InputFloat("Y##cs", &comp->mScale.Y);
+			ImGui::InputFloat("Z##cs", &comp->mScale.Z);
+			ImGui::Unindent();
+		}
 	}
 
 	/**
@@ -442,9 +452,9 @@ private:
 	 * @brief Display the component menu.
 	 * @param comp
 	 * @param entity
-	 * @param addedItems
+	 * @param events
 	*/
-	inline void DisplayComponentMenu(EditorComponentBase* comp, entt::entity const& entity, YmEventList& addedItems)
+	inline void DisplayComponentMenu(EditorComponentBase* comp, entt::entity const& entity, EventWriter& events)
 	{
 		auto  componentType = comp->GetTypeName();
 		if (ImGui::TreeNode(std::format("{}", componentType).c_str()))
@@ -452,9 +462,7 @@ private:
 			// It will short circuit and hide it in transform section
 			if (componentType != "Transform" && ImGui::Button("Remove component"))
 			{
-				addedItems.emplace_back(
-					EditorChange,
-					new Modification(entity, comp->ComponentType, false));
+				events.Emit(EditorChangeEvent{ entity, comp->ComponentType, false });
 				ImGui::TreePop();
 				return;
 			}
@@ -595,7 +603,9 @@ public:
 	*/
 	inline void Cleanup()
 	{
-		mGUI->drop();
+		// GUI is not initialized when running headless.
+		if (mGUI)
+			mGUI->drop();
 	}
 
 	/**
@@ -696,22 +706,18 @@ public:
 	/**
 	* @brief Display the main editor menu.
 	*/
-	[[nodiscard]] inline YmEventReturn DrawEntityManager(entt::registry& registry)
+	inline void DrawEntityManager(entt::registry& registry, EventWriter& events)
 	{
 		ImGui::SetNextWindowPos(ImVec2(50.0f, 50.0f), ImGuiSetCond_FirstUseEver | ImGuiSetCond_Once);
 		ImGui::SetNextWindowSize(ImVec2(350.0f, 600.0f), ImGuiSetCond_FirstUseEver | ImGuiSetCond_Once);
 
-		YmEventList addedItems;
-
 		if (ImGui::Begin("Editor", NULL, ImGuiWindowFlags_AlwaysAutoResize))
 		{
 			if (ImGui::Button("Add new entity"))
 			{
 				auto entity = registry.create();
 
-				addedItems.emplace_back(
-					EditorChange,
-					new Modification(entity, EditorComponentTypes::EditorTransformType, true));
+				events.Emit(EditorChangeEvent{ entity, EditorComponentTypes::EditorTransformType, true });
 				Log(LGR_INFO, "New entity added");
 			}
 
@@ -764,7 +770,7 @@ public:
 							continue;
 						}
 
-						PopulateComponentButtons(entity, addedItems, meshComp, colliderComp, scriptsComp, audioComp, cameraComp, lightComp, beaconNavComp);
+						PopulateComponentButtons(entity, events, meshComp, colliderComp, scriptsComp, audioComp, cameraComp, lightComp, beaconNavComp);
 
 						ImGui::TreePop();
 					}
@@ -773,7 +779,7 @@ public:
 					{
 						for (auto& comp : activeComponents)
 						{
-							DisplayComponentMenu(comp, entity, addedItems);
+							DisplayComponentMenu(comp, entity, events);
 						}
 						ImGui::TreePop();
 					}
@@ -784,12 +790,6 @@ public:
 			}
 		}
 		ImGui::End();
-
-
-		if (addedItems.size() > 0)
-			return addedItems;
-
-		return {};
 	}
 
 	// Scenes will need a file path and a scene id from 1 to 12 (based on f keys)
@@ -1018,9 +1018,8 @@ public:
 	/**
 	* @brief Show title screen.
 	*/
-	[[nodiscard]] inline YmEventReturn TitleScreenText()
+	inline void TitleScreenText(EventWriter& events)
 	{
-		YmEventList events;
 		ImGui::SetNextWindowPos(ImVec2(50, 50), ImGuiSetCond_FirstUseEver | ImGuiSetCond_Once);
 		ImGui::SetNextWindowSize(ImVec2(500.0f, 500.0f), ImGuiSetCond_FirstUseEver | ImGuiSetCond_Once);
 
@@ -1049,39 +1048,34 @@ public:
 
 			if (ImGui::Button("Title screen (F1)"))
 			{
-				events.emplace_back(YmEventTypes::ChangeScene, new SceneChangeMessage{ 1 });
+				events.Emit(ChangeSceneEvent{ 1 });
 			}
 
 			if (ImGui::Button("The game (F2)"))
 			{
-				events.emplace_back(YmEventTypes::ChangeScene, new SceneChangeMessage{ 2 });
+				events.Emit(ChangeSceneEvent{ 2 });
 			}
 
 			if (ImGui::Button("Exit (ESC)"))
 			{
-				events.emplace_back(YmEventTypes::ExitApplication, nullptr);
+				events.Emit(ExitApplicationEvent{});
 			}
 
 			ImGui::End();
 		}
 		ImGui::PopStyleColor(3);
-
-		if (events.size() > 0)
-			return events;
-
-		return {};
 	}
 
 	/**
 	* @brief Display the window for score submission.
+	* @return True if the user has made a choice, then the upload tells which one.
 	*/
-	[[nodiscard]] inline YmEventReturn ScoreSubmission(float const& score, std::string& name, bool& upload)
-	{ // The instead of the referenced arguments they could have been put into a return std::variant or tuple, but it would also probably need to be in a std::optional, so decided to check if something happened by using the std::optional within the YmEventReturn and only then check the bool from arguments.
+	[[nodiscard]] inline bool ScoreSubmission(float const& score, std::string& name, bool& upload, EventWriter& events)
+	{
 
 		ImGui::SetNextWindowPos(ImVec2(150, 150), ImGuiSetCond_FirstUseEver | ImGuiSetCond_Once);
 		ImGui::SetNextWindowSize(ImVec2(mWidth * 0.5f, mHeight * 0.5f), ImGuiSetCond_FirstUseEver | ImGuiSetCond_Once);
 
-		YmEventList sceneChange;
 		if (ImGui::Begin("Submit your score!", NULL, ImGuiWindowFlags_AlwaysAutoResize))
 		{
 			ImGui::Text(std::format("Your score is {}", score).c_str());
@@ -1109,12 +1103,12 @@ public:
 			ImGui::End();
 			if (changeScene)
 			{
-				sceneChange.emplace_back(YmEventTypes::ChangeScene, new SceneChangeMessage{ 1 });
-				return sceneChange;
+				events.Emit(ChangeSceneEvent{ 1 });
+				return true;
 			}
 		}
 
-		return {};
+		return false;
 	}
 #endif // GAME
 
@@ -1123,12 +1117,22 @@ public:
 	* @brief Draws profiling statistics window
 	* @param fps
 	* @param drawnPrimitives
+	* @param averageFrameTime Average of the recent frame times in seconds.
+	* @param worstFrameTime The slowest of the recent frame times in seconds.
+	* @param layerPairCounts Broad-phase pairs per collision layer combination.
+	* @param stepStats Counters of the last physics step.
+	* @param stepsThisFrame Fixed steps done in the frame.
+	* @param droppedTime Game time skipped because of the sub-step cap, in seconds.
 	*/
-	inline void DrawStats(signed int fps, unsigned int drawnPrimitives, size_t usedMemory, double usedCPU, float drawingTime
+	inline void DrawStats(signed int fps, unsigned int drawnPrimitives, size_t usedMemory, double usedCPU, float drawingTime, float averageFrameTime, float worstFrameTime
 #ifdef GAME
 						  ,float  gameScriptHandleTime
 						  , float physicsUpdateTime
 						  , float physicsResponseTime
+						  , std::vector<std::pair<std::string, unsigned int>> const& layerPairCounts
+						  , PhysicsStepStats const& stepStats
+						  , unsigned int stepsThisFrame
+						  , float droppedTime
 #endif // GAME
 						  )
 	{
@@ -1144,10 +1148,29 @@ public:
 			ImGui::Text(std::format("Memory usage(MB): ~{}", usedMemoryMod).c_str());
 			ImGui::Text(std::format("CPU usage(%%): ~{}", usedCPUMod).c_str());
 			ImGui::Text(std::format("Time Rendering(s): ~{}", drawingTime).c_str());
+			ImGui::Text(std::format("Frame time avg/worst(ms): ~{} / ~{}", averageFrameTime * 1000, worstFrameTime * 1000).c_str());
 #ifdef GAME
+			ImGui::Text(std::format("Fixed steps this frame: {}", stepsThisFrame).c_str());
+			ImGui::Text(std::format("Dropped game time(s): ~{}", droppedTime).c_str());
 			ImGui::Text(std::format("Time GameScripts(s): ~{}", gameScriptHandleTime).c_str());
 			ImGui::Text(std::format("Time Physics(s): ~{}", physicsUpdateTime).c_str());
 			ImGui::Text(std::format("Time Physics responses(s): ~{}", physicsResponseTime).c_str());
+
+			if (ImGui::CollapsingHeader("Physics step"))
+			{
+				ImGui::Text(std::format("Bodies active/sleeping: {} / {}", stepStats.mActiveBodies, stepStats.mSleepingBodies).c_str());
+				ImGui::Text(std::format("Islands: {}", stepStats.mIslands).c_str());
+				ImGui::Text(std::format("Broad-phase pairs: {}", stepStats.mBroadphasePairs).c_str());
+				ImGui::Text(std::format("Manifolds: {}", stepStats.mManifolds).c_str());
+				ImGui::Text(std::format("Contact points: {}", stepStats.mContactPoints).c_str());
+				ImGui::Text(std::format("Solver iterations: {}", stepStats.mSolverIterations).c_str());
+			}
+
+			if (ImGui::CollapsingHeader("Broad-phase pairs per layer"))
+			{
+				for (auto const& [layers, count] : layerPairCounts)
+					ImGui::Text(std::format("{}: {}", layers, count).c_str());
+			}
 #endif // GAME
 
 		}
@@ -1,10 +1,11 @@
 #ifdef GAME
 export module Component.Physics;
 import "btBulletDynamicsCommon.h";
+import "BulletCollision/CollisionDispatch/btGhostObject.h";
 import <memory>;
-import <deque>;
-import <set>;
-import <algorithm>;
+import <vector>;
+import <string>;
+import <unordered_map>;
 import Component.Transform;
 import Logger;
 import YaMath;
@@ -17,140 +18,306 @@ using std::make_unique;
 export enum ColliderShape
 {
 	Empty,
-	Box
+	Box,
+	Sphere,
+	Capsule,
+	ConvexHull,
+	Compound,
+	TriangleMesh
 };
 
 /**
- * @brief Physics managed component.
+ * @brief Triangles of a mesh, used to build the mesh colliders.
 */
-export class PhysicalBody
+export struct MeshGeometry
 {
-private:
+	std::vector<yamath::Vec3D> mVertices;
+
 	/**
-	 * @brief An owned reference to an entity within the physics engine.
-	 * @note For internal purposes only.
+	 * @brief Three vertex indices per triangle.
 	*/
-	unique_ptr<btRigidBody> mBody;
+	std::vector<int> mIndices;
+};
+
+export struct CompoundChild;
 
+/**
+ * @brief Parameters of a collider shape. Colliders with the same description share a single shape.
+*/
+export struct ShapeDescription
+{
 	/**
-	 * @brief A non owning reference to a physics world, that is managed by the wrapper.
-	 * @note Reference to the world used only for proper deletion. For internal purposes only.
+	 * @brief Type of the shape.
 	*/
-	btDynamicsWorld* mWorld;
+	ColliderShape mType = Box;
 
-	// The construction should only be done via the wrapper as it does all the needed assignments.
+	/**
+	 * @brief Half dimensions of a box.
+	*/
+	yamath::Vec3D mExtents{ 0, 0, 0 };
 
-	PhysicalBody(btDynamicsWorld* const world) : mWorld(world), mBody(nullptr) {};
+	/**
+	 * @brief Radius of a sphere or a capsule.
+	*/
+	float mRadius = 0;
 
-	// A casted entity id from ECS
-	// Used as there was no other way to get from the component to entity
-	// For getting info about collided entities
-	// Shouldn't have more entities than MAX_INT
-	// The libraries themselves are not included to reduce the dependencies and possible file bloat (as it's modules and they are "compiled")
-	// The components can't be reassigned for different entities
+	/**
+	 * @brief Height of the capsule's cylinder along the Y axis, without the caps.
+	*/
+	float mHeight = 0;
 
 	/**
-	 * @brief An entity ID representing Entity within the ECS.
+	 * @brief Mesh whose vertices make up the convex hull or the triangle mesh.
 	*/
-	int entityId = -1;
+	std::string mMeshPath;
+
+	/**
+	 * @brief Scale applied to the mesh vertices of the convex hull or the triangle mesh, as the physics does not use the transform scale.
+	*/
+	yamath::Vec3D mScale{ 1, 1, 1 };
 
-	std::set<int> mLastFrameCollidedObject;
-	std::set<int> mItemsCollidedWith;
+	/**
+	 * @brief Shapes of a compound.
+	*/
+	std::vector<CompoundChild> mChildren;
+};
 
-	std::set<int> mItemsLeftCollsionWith;
-	std::set<int> mItemsStayedInCollisionWith;
-	std::set<int> mItemsEnteredInCollisionWith;
+/**
+ * @brief A shape inside of a compound, placed relative to the compound's origin.
+*/
+export struct CompoundChild
+{
+	ShapeDescription mShape;
+	yamath::Vec3D mOffset{ 0, 0, 0 };
+	yamath::Quat mRotation;
+};
 
-private:
+/**
+ * @brief Broad-phase filter of a collision layer.
+ * @note Only the pairs whose layers accept each other reach the narrow-phase.
+*/
+export struct CollisionLayer
+{
 	/**
-	 * @brief compute the entity IDs that this object has left collision with.
+	 * @brief Name used in the scene files.
 	*/
-	inline void CalculateCollisionExits()
-	{
-		// old - new = exit
-		std::set_difference(mLastFrameCollidedObject.begin(), mLastFrameCollidedObject.end(), mItemsCollidedWith.begin(), mItemsCollidedWith.end(), std::inserter(mItemsLeftCollsionWith, mItemsLeftCollsionWith.end()));
-	}
+	std::string mName;
 
 	/**
-	 * @brief compute the entity IDs that this object has stayed in collision with.
+	 * @brief Bit of this layer.
 	*/
-	inline void CalculateCollisionStays()
-	{
-		// old & new = stay
-		std::set_intersection(mLastFrameCollidedObject.begin(), mLastFrameCollidedObject.end(), mItemsCollidedWith.begin(), mItemsCollidedWith.end(), std::inserter(mItemsStayedInCollisionWith, mItemsStayedInCollisionWith.end()));
-	}
+	int mGroup = 0;
 
 	/**
-	 * @brief compute the entity IDs that this object has entered into collision with.
+	 * @brief Bits of the layers that this one collides with.
 	*/
-	inline void CalculateCollisionEnters()
-	{
-		// new - old = enter
-		std::set_difference(mItemsCollidedWith.begin(), mItemsCollidedWith.end(), mLastFrameCollidedObject.begin(), mLastFrameCollidedObject.end(), std::inserter(mItemsEnteredInCollisionWith, mItemsEnteredInCollisionWith.end()));
-	}
+	int mMask = 0;
+};
+
+/**
+ * @brief Two entities in contact.
+*/
+export struct ContactPair
+{
+	int mFirst;
+	int mSecond;
+};
+
+/**
+ * @brief Contact changes of the last physics step.
+ * @note Every pair is stored once with the lower entity ID first, and the arrays are sorted.
+*/
+export struct ContactEvents
+{
+	std::vector<ContactPair> mEntered;
+	std::vector<ContactPair> mStayed;
+	std::vector<ContactPair> mExited;
+};
+
+/**
+ * @brief Counters of the last physics step, to tell why a step took longer than usual.
+*/
+export struct PhysicsStepStats
+{
+	/**
+	 * @brief Moving bodies that were simulated, including the kinematic ones.
+	*/
+	unsigned int mActiveBodies = 0;
+
+	/**
+	 * @brief Moving bodies that were put to sleep and skipped by the solver.
+	*/
+	unsigned int mSleepingBodies = 0;
+
+	/**
+	 * @brief Overlapping pairs found by the broad-phase.
+	*/
+	unsigned int mBroadphasePairs = 0;
+
+	/**
+	 * @brief Persistent manifolds, one per pair that passed the narrow-phase checks.
+	*/
+	unsigned int mManifolds = 0;
+
+	/**
+	 * @brief Contact points of all of the manifolds.
+	*/
+	unsigned int mContactPoints = 0;
+
+	/**
+	 * @brief Solver iterations over all of the simulated sub-steps.
+	*/
+	unsigned int mSolverIterations = 0;
 
+	/**
+	 * @brief Groups of touching awake bodies that are solved together.
+	*/
+	unsigned int mIslands = 0;
+};
+
+/**
+ * @brief Motion state that Bullet writes the simulated transform into, keeping it in the engine's position and rotation as well.
+ * @note Bullet only writes into the motion states of the moving bodies, so the conversion is done once per moved body and nothing is fetched for the rest.
+ In the multithreaded world the writes happen on the worker threads, but every body has its own state.
+*/
+export class EntityMotionState : public btMotionState
+{
 public:
 	/**
-	 * @brief Collider shape.
+	 * @brief World transform of the collider, including the offset.
 	*/
-	ColliderShape mShape;
+	btTransform mTransform;
 
-	// These could be deque, but the issue is that I am already throwing away the data for collision point, so what's the point
+	/**
+	 * @brief Offset of the collider from the entity position.
+	*/
 	yamath::Vec3D mOffset;
 
-public:
-	~PhysicalBody()
+	/**
+	 * @brief Entity position, without the offset.
+	*/
+	yamath::Vec3D mPosition;
+
+	/**
+	 * @brief Entity rotation.
+	*/
+	yamath::Quat mRotation;
+
+	/**
+	 * @brief Flag for a transform written by the physics engine, which was not read by the engine yet.
+	*/
+	bool mMoved = false;
+
+	explicit EntityMotionState(btTransform const& transform) : mTransform(transform) {}
+
+	void getWorldTransform(btTransform& worldTrans) const override
 	{
-		if (mBody)
-		{
-			if (mWorld)
-				mWorld->removeCollisionObject(mBody.get());
+		worldTrans = mTransform;
+	}
 
-			auto motionState = mBody->getMotionState();
-			if (motionState)
-				delete motionState;
+	void setWorldTransform(btTransform const& worldTrans) override
+	{
+		mTransform = worldTrans;
 
-			auto shape = mBody->getCollisionShape();
-			if (shape)
-				delete shape;
-		}
+		auto const& origin = worldTrans.getOrigin();
+		mPosition = yamath::opr::Sub({ origin.getX(), origin.getY(), origin.getZ() }, mOffset);
+
+		auto const rotation = worldTrans.getRotation();
+		mRotation = { rotation.getX(), rotation.getY(), rotation.getZ(), rotation.getW() };
+
+		mMoved = true;
 	}
+};
 
+/**
+ * @brief Physics managed component.
+*/
+export class PhysicalBody
+{
+private:
 	/**
-	 * @brief Get entities the object has entered into collision with.
-	 * @return
+	 * @brief Collision shape of the body, shared with the other bodies of the same shape through the wrapper's cache.
+	 * @note Declared before the collision objects, so that it outlives them. For internal purposes only.
 	*/
-	inline std::set<int> GetItemsEnterdCollisionWith() const noexcept
-	{
-		return mItemsEnteredInCollisionWith;
-	}
+	std::shared_ptr<btCollisionShape> mCollisionShape;
 
 	/**
-	 * @brief Get entities the object has stayed in collision with.
-	 * @return
+	 * @brief An owned reference to an entity within the physics engine.
+	 * @note For internal purposes only.
 	*/
-	inline std::set<int> GetItemsStayedCollisionWith() const noexcept
-	{
-		return mItemsStayedInCollisionWith;
-	}
+	unique_ptr<btRigidBody> mBody;
 
 	/**
-	 * @brief Get entities the object has left the collision with.
-	 * @return
+	 * @brief An owned motion state of the rigid body. Created once with the body and updated in place afterwards.
+	 * @note For internal purposes only.
+	*/
+	unique_ptr<EntityMotionState> mMotionState;
+
+	/**
+	 * @brief An owned trigger collider, used instead of the rigid body. Reports overlaps through the contacts, but is never pushed or solved.
+	 * @note For internal purposes only.
+	*/
+	unique_ptr<btGhostObject> mTrigger;
+
+	/**
+	 * @brief Entities of the compound children, when the body is made of merged static colliders. Indexed by the child index.
+	 * @note Kept on the heap, as the rigid body points to it through its user pointer. For internal purposes only.
+	*/
+	unique_ptr<std::vector<int>> mChildEntities;
+
+	/**
+	 * @brief A non owning reference to a physics world, that is managed by the wrapper.
+	 * @note Reference to the world used only for proper deletion. For internal purposes only.
+	*/
+	btDynamicsWorld* mWorld;
+
+	// The construction should only be done via the wrapper as it does all the needed assignments.
+
+	PhysicalBody(btDynamicsWorld* const world) : mWorld(world), mBody(nullptr), mTrigger(nullptr) {};
+
+	/**
+	 * @brief Get the world transform of the collider.
 	*/
-	inline std::set<int> GetItemsLeftCollisionWith() const noexcept
+	inline btTransform GetWorldTransform() const
 	{
-		return  mItemsLeftCollsionWith;
+		if (mTrigger)
+			return mTrigger->getWorldTransform();
+
+		return mMotionState->mTransform;
 	}
 
+	// A casted entity id from ECS
+	// Used as there was no other way to get from the component to entity
+	// For getting info about collided entities
+	// Shouldn't have more entities than MAX_INT
+	// The libraries themselves are not included to reduce the dependencies and possible file bloat (as it's modules and they are "compiled")
+	// The components can't be reassigned for different entities
+
 	/**
-	 * @brief Add ID to the set of items the object has collided with in this frame.
-	 * @param
-	 * @return
+	 * @brief An entity ID representing Entity within the ECS.
+	*/
+	int entityId = -1;
+
+public:
+	/**
+	 * @brief Collider shape.
 	*/
-	inline void AddIDToItemsCollidedWith(int ID) noexcept
+	ColliderShape mShape;
+
+	/**
+	 * @brief Offset of the collider from the entity position.
+	*/
+	yamath::Vec3D mOffset;
+
+public:
+	~PhysicalBody()
 	{
-		mItemsCollidedWith.insert(ID);
+		// The shape is owned by the cache and the bodies that use it, so it is not deleted here.
+		if (mBody && mWorld)
+			mWorld->removeCollisionObject(mBody.get());
+
+		if (mTrigger && mWorld)
+			mWorld->removeCollisionObject(mTrigger.get());
 	}
 
 	// Copy is not intended because the object has to be added via the wrapper in order to register the new entity
@@ -158,76 +325,106 @@ public:
 	PhysicalBody& operator=(PhysicalBody const& copy) = delete;
 
 	PhysicalBody(PhysicalBody&& move) noexcept :
+		mCollisionShape(std::move(move.mCollisionShape)),
 		mBody(std::move(move.mBody)),
+		mMotionState(std::move(move.mMotionState)),
+		mTrigger(std::move(move.mTrigger)),
 		mShape(std::exchange(move.mShape, ColliderShape::Empty)),
-		mItemsCollidedWith(std::move(move.mItemsCollidedWith)),
-		mLastFrameCollidedObject(std::move(move.mLastFrameCollidedObject)),
 		mWorld(std::move(move.mWorld)),
 		mOffset(std::move(move.mOffset)),
-		entityId(std::exchange(move.entityId, -1)),
-		mItemsLeftCollsionWith(std::move(move.mItemsLeftCollsionWith)),
-		mItemsStayedInCollisionWith(std::move(move.mItemsStayedInCollisionWith)),
-		mItemsEnteredInCollisionWith(std::move(move.mItemsEnteredInCollisionWith))
-
+		mChildEntities(std::move(move.mChildEntities)),
+		entityId(std::exchange(move.entityId, -1))
 	{
-		// Otherwise it will reference the object moved from and the casting will break;
-		if (mBody)
-			mBody->setUserPointer(this);
 	}
 	PhysicalBody& operator= (PhysicalBody&& move) noexcept
 	{
-		mBody = std::move(move.mBody);
-
+		// The old collision objects have to leave the world before their shape can be released.
+		if (mBody && mWorld)
+			mWorld->removeCollisionObject(mBody.get());
+		if (mTrigger && mWorld)
+			mWorld->removeCollisionObject(mTrigger.get());
 
-		if (mBody)
-			mBody->setUserPointer(this);
+		mBody = std::move(move.mBody);
+		mMotionState = std::move(move.mMotionState);
+		mTrigger = std::move(move.mTrigger);
+		mCollisionShape = std::move(move.mCollisionShape);
 		mShape = std::exchange(move.mShape, Empty);
-		mItemsCollidedWith = std::move(move.mItemsCollidedWith);
-		mLastFrameCollidedObject = std::move(move.mLastFrameCollidedObject);
 		mWorld = std::move(move.mWorld);
 		mOffset = std::move(move.mOffset);
+		mChildEntities = std::move(move.mChildEntities);
 
 		// This is working for now, but I am not sure what will happen if the entity ID will be reused by entt, which I'm not sure if it does
 		// As a note entt does move and pop when deleting an element, meaning the move operators will be used
 		entityId = std::exchange(move.entityId, -1);
 
-		mItemsLeftCollsionWith = std::move(move.mItemsLeftCollsionWith);
-		mItemsStayedInCollisionWith = std::move(move.mItemsStayedInCollisionWith);
-		mItemsEnteredInCollisionWith = std::move(move.mItemsEnteredInCollisionWith);
-
-
 		return *this;
 	}
 
 	/**
 	 * @brief Update the physics component with the position and rotation.
 	 * @note Would be decoupled if there were uses cases for that.
+	 * @param pos
+	 * @param rot
+	 * @param teleport Place a kinematic body without moving it through the space between, e.g. when it is placed for the first time.
 	*/
-	inline void SetPositionRotation(yamath::Vec3D const& pos, yamath::Vec3D const& rot)
+	inline void SetPositionRotation(yamath::Vec3D const& pos, yamath::Quat const& rot, bool const teleport = false)
 	{
-		// A new motion state has to be created as if only an old one is set it will get replaced by what was set in the Create physics item function
-		delete mBody->getMotionState();
 		btTransform transform;
 		transform.setIdentity();
 		auto offset = yamath::opr::Add(pos, mOffset);
 		transform.setOrigin(btVector3(offset.X, offset.Y, offset.Z));
 
-		btQuaternion qtrn(0, 0, 0);
-		qtrn.setEulerZYX(yamath::opr::ToRadians(rot.Z),
-						 yamath::opr::ToRadians(rot.Y),
-						 yamath::opr::ToRadians(rot.X));
-		transform.setRotation(qtrn);
+		transform.setRotation(btQuaternion(rot.X, rot.Y, rot.Z, rot.W));
+
+		if (mTrigger)
+		{
+			mTrigger->setWorldTransform(transform);
+			return;
+		}
+
+		mMotionState->mTransform = transform;
+		mMotionState->mPosition = pos;
+		mMotionState->mRotation = rot;
+		mMotionState->mMoved = false;
+
+		// Kinematic bodies are read from the motion state during the step, which gives them the velocity of the move.
+		if (mBody->isKinematicObject() && !teleport)
+			return;
 
+		mBody->setWorldTransform(transform);
+		mBody->setInterpolationWorldTransform(transform);
+	}
+
+	/**
+	 * @brief Check if the physics engine has moved the body since the last call, clearing the flag.
+	 * @note Static, kinematic, sleeping bodies and triggers are never moved by the physics engine.
+	*/
+	inline bool TakeMoved() noexcept
+	{
+		if (!mMotionState || !mMotionState->mMoved)
+			return false;
 
-		auto motion = new btDefaultMotionState(transform);
-		mBody->setMotionState(motion);
+		mMotionState->mMoved = false;
+		return true;
+	}
+
+	/**
+	 * @brief Check if the collider is a trigger, which only reports overlaps.
+	*/
+	inline bool IsTrigger() const noexcept
+	{
+		return mTrigger != nullptr;
 	}
 
 	/**
 	 * @brief And impulse force to the object.
+	 * @note Triggers are not affected by forces.
 	*/
 	inline void AddImpulseForce(yamath::Vec3D const& force, yamath::Vec3D const& relativePos = { 0, 9, 0 })
 	{
+		if (!mBody)
+			return;
+
 		btVector3 appliedForce(force.X, force.Y, force.Z);
 		btVector3 relativePosition(relativePos.X, relativePos.Y, relativePos.Z);
 		mBody->applyImpulse(appliedForce, relativePosition);
@@ -239,6 +436,9 @@ public:
 	*/
 	inline void SetLinearVelocity(float xVel, float yVel, float zVel)
 	{
+		if (!mBody)
+			return;
+
 		btVector3 linearVelocity(xVel, yVel, zVel);
 		mBody->setLinearVelocity(linearVelocity);
 	}
@@ -250,45 +450,14 @@ public:
 	*/
 	inline yamath::Vec3D GetVelocity(yamath::Vec3D const& relativePosition = { 0, 0, 0 })
 	{
+		if (!mBody)
+			return { 0, 0, 0 };
 
 		auto btVelocity = mBody->getVelocityInLocalPoint(btVector3(relativePosition.X, relativePosition.Y, relativePosition.Z));
 
 		return { btVelocity.getX(), btVelocity.getY(), btVelocity.getZ() };
 	}
 
-	// This approach creates an expectation that collision detection will be called every frame, which it wasn't at high game steps :'(
-
-	// Collisions lists should be treated like this:
-	// 0) mLastFrameCollidedObject contains the data from the last frame
-	// 1) list for this frame is populated with new data in the current frame
-	// 2) a difference is counted, which results in collision left, new and stay
-	// 3) current frame data is flushed to the mLastFrameCollidedObject, so it has it in the next frame
-
-	/**
-	 * @brief Flush the previous collision data.
-	 * To prepare for the next step.
-	*/
-	inline void FlushCollision()
-	{
-		mItemsLeftCollsionWith.clear();
-		mItemsStayedInCollisionWith.clear();
-		mItemsEnteredInCollisionWith.clear();
-
-		mLastFrameCollidedObject = mItemsCollidedWith;
-		mItemsCollidedWith.clear();
-	}
-
-	/**
-	 * @brief Calculate the newest data about physics events.
-	 * @return
-	*/
-	inline void CalculateCollisionCollections()
-	{
-		CalculateCollisionStays();
-		CalculateCollisionExits();
-		CalculateCollisionEnters();
-	}
-
 	/**
 	 * @brief Gets stored entity ID.
 	 * @return
@@ -304,7 +473,17 @@ public:
 	*/
 	inline void DisableSleep()
 	{
-		mBody->setActivationState(DISABLE_DEACTIVATION);
+		if (mBody)
+			mBody->setActivationState(DISABLE_DEACTIVATION);
+	}
+
+	/**
+	 * @brief Check if the physics engine can move this object.
+	 * @return False if the object is static, sleeping or a trigger.
+	*/
+	inline bool IsAwake() const
+	{
+		return mBody && mBody->isActive() && !mBody->isStaticOrKinematicObject();
 	}
 
 	/**
@@ -313,10 +492,7 @@ public:
 	*/
 	inline void LogPos() const
 	{
-		btTransform btTrans;
-		mBody->getMotionState()->getWorldTransform(btTrans);
-
-		auto btVec3 = btTrans.getOrigin();
+		auto btVec3 = GetWorldTransform().getOrigin();
 		Log(LGR_INFO, std::format("Position at: {} {} {}", btVec3.getX(), btVec3.getY(), btVec3.getZ()));
 	}
 
@@ -326,10 +502,10 @@ public:
 	*/
 	inline yamath::Vec3D GetPosition() const
 	{
-		btTransform btTrans;
-		mBody->getMotionState()->getWorldTransform(btTrans);
+		if (mMotionState)
+			return mMotionState->mPosition;
 
-		auto btVec3 = btTrans.getOrigin();
+		auto btVec3 = GetWorldTransform().getOrigin();
 		yamath::Vec3D origin{ btVec3.getX() , btVec3.getY(), btVec3.getZ() };
 
 		return yamath::opr::Sub(origin, mOffset);
@@ -339,20 +515,251 @@ public:
 	 * @brief Get the rotation of the physics object.
 	 * @return
 	*/
-	inline yamath::Vec3D GetRotation() const
+	inline yamath::Quat GetRotation() const
+	{
+		if (mMotionState)
+			return mMotionState->mRotation;
+
+		auto rotation = mTrigger->getWorldTransform().getRotation();
+		return { rotation.getX(), rotation.getY(), rotation.getZ(), rotation.getW() };
+	}
+	friend class PhysicsWrapper;
+};
+
+/**
+ * @brief State of a collision object at the moment of a snapshot.
+ * @note Plain data, so the whole snapshot is a single flat buffer.
+*/
+export struct BodyState
+{
+	/**
+	 * @brief The object the state belongs to, only compared against and never dereferenced from the snapshot.
+	*/
+	btCollisionObject const* mObject;
+
+	/**
+	 * @brief Entity of the object, guards against a new object that reuses the address of a removed one.
+	*/
+	int mEntity;
+
+	int mActivationState;
+	float mDeactivationTime;
+	float mPosition[3];
+	float mRotation[4];
+	float mLinearVelocity[3];
+	float mAngularVelocity[3];
+};
+
+/**
+ * @brief Binary snapshot of every body in the physics world, which can be restored in place instead of rebuilding the bodies.
+ * @note Bodies removed after the capture are skipped by the restore, and the ones added after it are left as they are.
+*/
+export class PhysicsSnapshot
+{
+private:
+	/**
+	 * @brief States sorted by the object address.
+	*/
+	std::vector<BodyState> mStates;
+public:
+	/**
+	 * @brief Check if the snapshot holds any bodies.
+	*/
+	inline bool IsEmpty() const noexcept
+	{
+		return mStates.empty();
+	}
+
+	/**
+	 * @brief Get the size of the snapshot in bytes.
+	*/
+	inline size_t GetSize() const noexcept
+	{
+		return mStates.size() * sizeof(BodyState);
+	}
+	friend class PhysicsWrapper;
+};
+
+/**
+ * @brief Ray from a point to another one.
+*/
+export struct RayQuery
+{
+	/**
+	 * @brief Entity the query is made for. The results are keyed by it and its own colliders are not hit.
+	*/
+	int mEntity = -1;
+
+	yamath::Vec3D mFrom{ 0, 0, 0 };
+	yamath::Vec3D mTo{ 0, 0, 0 };
+
+	/**
+	 * @brief Collision layer groups that can be hit, every layer by default.
+	*/
+	int mMask = -1;
+};
+
+/**
+ * @brief Convex shape moved from a point to another one.
+*/
+export struct SweepQuery
+{
+	/**
+	 * @brief Entity the query is made for. The results are keyed by it and its own colliders are not hit.
+	*/
+	int mEntity = -1;
+
+	/**
+	 * @brief Swept shape, has to be convex (box, sphere, capsule or convex hull).
+	*/
+	ShapeDescription mShape;
+
+	yamath::Vec3D mFrom{ 0, 0, 0 };
+	yamath::Vec3D mTo{ 0, 0, 0 };
+	yamath::Quat mRotation;
+
+	/**
+	 * @brief Collision layer groups that can be hit, every layer by default.
+	*/
+	int mMask = -1;
+};
+
+/**
+ * @brief Convex shape placed in the world, to find the colliders it touches.
+*/
+export struct OverlapQuery
+{
+	/**
+	 * @brief Entity the query is made for. The results are keyed by it and its own colliders are not reported.
+	*/
+	int mEntity = -1;
+
+	/**
+	 * @brief Tested shape, has to be convex (box, sphere, capsule or convex hull).
+	*/
+	ShapeDescription mShape;
+
+	yamath::Vec3D mPosition{ 0, 0, 0 };
+	yamath::Quat mRotation;
+
+	/**
+	 * @brief Collision layer groups that can be reported, every layer by default.
+	*/
+	int mMask = -1;
+};
+
+/**
+ * @brief Closest hit of a ray or a sweep.
+*/
+export struct QueryHit
+{
+	/**
+	 * @brief Hit entity, -1 if nothing was hit.
+	*/
+	int mEntity = -1;
+
+	/**
+	 * @brief Hit point in the world.
+	*/
+	yamath::Vec3D mPoint{ 0, 0, 0 };
+
+	/**
+	 * @brief Normal of the hit surface.
+	*/
+	yamath::Vec3D mNormal{ 0, 0, 0 };
+
+	/**
+	 * @brief Distance to the hit as a fraction of the query length.
+	*/
+	float mFraction = 1;
+
+	inline bool HasHit() const noexcept
+	{
+		return mEntity >= 0;
+	}
+};
+
+/**
+ * @brief World queries of the game scripts. Scripts add their queries during the step, and they are all run in a single batch after the physics step.
+ * @note Stored in the registry context, so the scripts get it with registry.try_ctx<PhysicsQueries>(). The results are the ones of the last batch, i.e. the previous step.
+ Every entity gets one result of each kind per step, if it made more queries of the same kind the last one is kept.
+*/
+export class PhysicsQueries
+{
+private:
+	std::vector<RayQuery> mRays;
+	std::vector<SweepQuery> mSweeps;
+	std::vector<OverlapQuery> mOverlaps;
+
+	std::unordered_map<int, QueryHit> mRayHits;
+	std::unordered_map<int, QueryHit> mSweepHits;
+	std::unordered_map<int, std::vector<int>> mOverlapHits;
+public:
+	/**
+	 * @brief Cast a ray in the next batch.
+	*/
+	inline void CastRay(RayQuery const& query)
+	{
+		mRays.push_back(query);
+	}
+
+	/**
+	 * @brief Sweep a shape in the next batch.
+	*/
+	inline void Sweep(SweepQuery const& query)
+	{
+		mSweeps.push_back(query);
+	}
+
+	/**
+	 * @brief Find the overlaps of a shape in the next batch.
+	*/
+	inline void Overlap(OverlapQuery const& query)
+	{
+		mOverlaps.push_back(query);
+	}
+
+	/**
+	 * @brief Get the result of the entity's ray from the last batch.
+	 * @return Null if the entity did not cast a ray.
+	*/
+	inline QueryHit const* GetRayHit(int const entity) const
+	{
+		auto result = mRayHits.find(entity);
+		return result != mRayHits.end() ? &result->second : nullptr;
+	}
+
+	/**
+	 * @brief Get the result of the entity's sweep from the last batch.
+	 * @return Null if the entity did not sweep a shape.
+	*/
+	inline QueryHit const* GetSweepHit(int const entity) const
+	{
+		auto result = mSweepHits.find(entity);
+		return result != mSweepHits.end() ? &result->second : nullptr;
+	}
+
+	/**
+	 * @brief Get the entities touched by the entity's overlap query in the last batch.
+	 * @return Null if the entity did not make an overlap query.
+	*/
+	inline std::vector<int> const* GetOverlaps(int const entity) const
+	{
+		auto result = mOverlapHits.find(entity);
+		return result != mOverlapHits.end() ? &result->second : nullptr;
+	}
+
+	/**
+	 * @brief Forget the queries and their results, e.g. when the scene is changed and the entity IDs get reused.
+	*/
+	inline void Clear()
 	{
-		btTransform btTrans;
-		mBody->getMotionState()->getWorldTransform(btTrans);
-
-		yamath::Vec3D rotation;
-		float x, y, z;
-
-		auto a = mBody->getOrientation();
-		// For this yaw is Z, pitch is y and roll is x,
-		a.getEulerZYX(z, y, x);
-		return { yamath::opr::ToDegrees(x),
-				yamath::opr::ToDegrees(y),
-				yamath::opr::ToDegrees(z) };
+		mRays.clear();
+		mSweeps.clear();
+		mOverlaps.clear();
+		mRayHits.clear();
+		mSweepHits.clear();
+		mOverlapHits.clear();
 	}
 	friend class PhysicsWrapper;
 };
@@ -2,15 +2,268 @@
 export module PhysicsWrapper;
 import Logger;
 import "btBulletDynamicsCommon.h";
+import "BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h";
+import "BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h";
+import "LinearMath/btThreads.h";
+import "BulletCollision/NarrowPhaseCollision/btGjkPairDetector.h";
+import "BulletCollision/NarrowPhaseCollision/btGjkEpaPenetrationDepthSolver.h";
+import "BulletCollision/NarrowPhaseCollision/btVoronoiSimplexSolver.h";
+import "BulletCollision/NarrowPhaseCollision/btPointCollector.h";
+import "BulletCollision/CollisionShapes/btTriangleShape.h";
 import <memory>;
+import <mutex>;
 import Component.Transform;
 import <vector>;
+import <algorithm>;
+import <cstdint>;
+import <string>;
+import <bit>;
+import <optional>;
+import <functional>;
+import <unordered_map>;
+import <fstream>;
 import YaMath;
+import JobSystem;
 export import Component.Physics;
 using std::unique_ptr;
 using std::make_unique;
 
-bool collisionStartedCallback(btManifoldPoint& collisionPoint, btCollisionObjectWrapper const* obj1, int id1, int index1, btCollisionObjectWrapper const* obj2, int id2, int index2);
+// Contacts are read from the persistent manifolds once per step instead of a callback per added contact point.
+// The callback only fired for new points, so a resting contact whose points were kept by the manifold could drop out of the "stay" set.
+
+// The multithreaded world only works if Bullet itself was built with BT_THREADSAFE (BULLET2_MULTITHREADING in its CMake), otherwise its parallel loops run on the calling thread.
+
+// World queries run in parallel, so they walk the broad-phase trees with btDbvt's re-entrant traversals instead of btCollisionWorld::rayTest/convexSweepTest,
+// which share a single traversal stack in the broad-phase. The narrow-phase only reads the shapes, and the overlap tests use GJK directly instead of the dispatcher, whose algorithm pool is not thread safe.
+
+// Building the BVH of a big triangle mesh takes a while, so it is baked into a file next to the mesh and loaded in place on the next run.
+// The file starts with a header, followed by the output of btOptimizedBvh::serializeInPlace. It only works for the same Bullet build and endianness.
+
+/**
+ * @brief Header of a baked triangle mesh BVH.
+*/
+struct BakedBvhHeader
+{
+	char mMagic[4] = { 'Y', 'B', 'V', 'H' };
+
+	/**
+	 * @brief Changed whenever the layout or the build settings change, so the old files get rebuilt.
+	*/
+	std::uint32_t mVersion = 1;
+
+	/**
+	 * @brief Hash of the triangles the BVH was built from, so that a changed mesh is not paired with an old tree.
+	*/
+	std::uint64_t mGeometryHash = 0;
+
+	/**
+	 * @brief Size of the serialized BVH that follows the header.
+	*/
+	std::uint32_t mBvhSize = 0;
+
+	std::uint32_t mReserved = 0;
+};
+
+/**
+ * @brief Data that a triangle mesh shape points to, but does not own.
+*/
+struct TriangleMeshData
+{
+	MeshGeometry mGeometry;
+	unique_ptr<btTriangleIndexVertexArray> mMeshInterface;
+
+	/**
+	 * @brief Aligned buffer that the baked BVH was deserialized into, null if the shape built its own.
+	*/
+	void* mBvhBuffer = nullptr;
+
+	~TriangleMeshData()
+	{
+		if (mBvhBuffer)
+			btAlignedFree(mBvhBuffer);
+	}
+};
+
+/**
+ * @brief Runs the parallel loops of Bullet on the engine's job system, so that the physics does not start its own threads.
+ * @note Bullet gives the main thread index 0 and the other threads the next free index, which is why every job system thread is counted, even if the work is split between fewer of them.
+*/
+class JobTaskScheduler : public btITaskScheduler
+{
+private:
+	/**
+	 * @brief Maximal amount of batches a loop is split into.
+	*/
+	int mNumThreads;
+public:
+	explicit JobTaskScheduler(int const numThreads) : btITaskScheduler("YamaJobSystem")
+	{
+		// Index 0 is taken by the main thread, so the workers have to start from 1.
+		m_savedThreadCounter = 1;
+		mNumThreads = std::clamp(numThreads, 1, getMaxNumThreads());
+	}
+
+	int getMaxNumThreads() const override
+	{
+		return std::min((int)JobSystem::Instance().GetThreadCount(), (int)BT_MAX_THREAD_COUNT);
+	}
+
+	int getNumThreads() const override
+	{
+		return getMaxNumThreads();
+	}
+
+	void setNumThreads(int numThreads) override
+	{
+		mNumThreads = std::clamp(numThreads, 1, getMaxNumThreads());
+	}
+
+	void parallelFor(int iBegin, int iEnd, int grainSize, btIParallelForBody const& body) override
+	{
+		auto count = (size_t)std::max(0, iEnd - iBegin);
+		auto batchSize = std::max<size_t>(grainSize, (count + mNumThreads - 1) / mNumThreads);
+
+		JobSystem::Instance().ParallelFor(count, batchSize, [&body, iBegin](size_t start, size_t end)
+										  {
+											  body.forLoop(iBegin + (int)start, iBegin + (int)end);
+										  });
+	}
+
+	btScalar parallelSum(int iBegin, int iEnd, int grainSize, btIParallelSumBody const& body) override
+	{
+		auto count = (size_t)std::max(0, iEnd - iBegin);
+		auto batchSize = std::max<size_t>(grainSize, (count + mNumThreads - 1) / mNumThreads);
+
+		std::mutex sumMutex;
+		btScalar sum = 0;
+		JobSystem::Instance().ParallelFor(count, batchSize, [&body, &sumMutex, &sum, iBegin](size_t start, size_t end)
+										  {
+											  auto partialSum = body.sumLoop(iBegin + (int)start, iBegin + (int)end);
+											  std::lock_guard lock(sumMutex);
+											  sum += partialSum;
+										  });
+		return sum;
+	}
+};
+
+/**
+ * @brief Calls the function with the collision object of every broad-phase leaf that is found.
+*/
+template<typename Function>
+struct LeafCollector : btDbvt::ICollide
+{
+	Function& mFunction;
+
+	explicit LeafCollector(Function& function) : mFunction(function) {}
+
+	void Process(btDbvtNode const* leaf) override
+	{
+		mFunction((btCollisionObject*)((btDbvtProxy*)leaf->data)->m_clientObject);
+	}
+};
+
+/**
+ * @brief Closest ray hit, keeping the hit compound child.
+*/
+struct ChildRayCallback : btCollisionWorld::ClosestRayResultCallback
+{
+	/**
+	 * @brief Index of the hit compound child, -1 if the hit shape is not a compound.
+	 * @note Only closer hits are added, so it always belongs to the closest hit.
+	*/
+	int mChildIndex = -1;
+
+	using ClosestRayResultCallback::ClosestRayResultCallback;
+
+	btScalar addSingleResult(btCollisionWorld::LocalRayResult& rayResult, bool normalInWorldSpace) override
+	{
+		mChildIndex = rayResult.m_localShapeInfo ? rayResult.m_localShapeInfo->m_triangleIndex : -1;
+		return ClosestRayResultCallback::addSingleResult(rayResult, normalInWorldSpace);
+	}
+};
+
+/**
+ * @brief Closest sweep hit, keeping the hit compound child.
+*/
+struct ChildConvexCallback : btCollisionWorld::ClosestConvexResultCallback
+{
+	/**
+	 * @brief Index of the hit compound child, -1 if the hit shape is not a compound.
+	*/
+	int mChildIndex = -1;
+
+	using ClosestConvexResultCallback::ClosestConvexResultCallback;
+
+	btScalar addSingleResult(btCollisionWorld::LocalConvexResult& convexResult, bool normalInWorldSpace) override
+	{
+		mChildIndex = convexResult.m_localShapeInfo ? convexResult.m_localShapeInfo->m_triangleIndex : -1;
+		return ClosestConvexResultCallback::addSingleResult(convexResult, normalInWorldSpace);
+	}
+};
+
+/**
+ * @brief Check if a convex shape overlaps with another shape of any kind.
+*/
+bool ConvexOverlaps(btConvexShape const* convex, btTransform const& convexTransform, btCollisionShape const* shape, btTransform const& shapeTransform)
+{
+	if (shape->isConvex())
+	{
+		btVoronoiSimplexSolver simplexSolver;
+		btGjkEpaPenetrationDepthSolver penetrationSolver;
+		btGjkPairDetector detector(convex, (btConvexShape const*)shape, &simplexSolver, &penetrationSolver);
+
+		btGjkPairDetector::ClosestPointInput input;
+		input.m_transformA = convexTransform;
+		input.m_transformB = shapeTransform;
+		btPointCollector output;
+		detector.getClosestPoints(input, output, nullptr);
+		return output.m_hasResult && output.m_distance <= 0;
+	}
+
+	if (shape->isCompound())
+	{
+		auto compound = (btCompoundShape const*)shape;
+		for (int i = 0; i < compound->getNumChildShapes(); i++)
+		{
+			if (ConvexOverlaps(convex, convexTransform, compound->getChildShape(i), shapeTransform * compound->getChildTransform(i)))
+				return true;
+		}
+		return false;
+	}
+
+	if (shape->isConcave())
+	{
+		struct TriangleOverlap : btTriangleCallback
+		{
+			btConvexShape const* mConvex;
+			btTransform mConvexTransform;
+			btTransform mShapeTransform;
+			bool mOverlaps = false;
+
+			void processTriangle(btVector3* triangle, int partId, int triangleIndex) override
+			{
+				if (mOverlaps)
+					return;
+
+				btTriangleShape triangleShape(triangle[0], triangle[1], triangle[2]);
+				mOverlaps = ConvexOverlaps(mConvex, mConvexTransform, &triangleShape, mShapeTransform);
+			}
+		};
+
+		TriangleOverlap callback;
+		callback.mConvex = convex;
+		callback.mConvexTransform = convexTransform;
+		callback.mShapeTransform = shapeTransform;
+
+		// Only the triangles within the bounds of the convex shape are tested, in the local space of the mesh.
+		btVector3 min, max;
+		convex->getAabb(shapeTransform.inverse() * convexTransform, min, max);
+		((btConcaveShape const*)shape)->processAllTriangles(&callback, min, max);
+		return callback.mOverlaps;
+	}
+
+	return false;
+}
 
 /**
  * @brief Wrapper for Bullet physics engine.
@@ -18,6 +271,12 @@ bool collisionStartedCallback(btManifoldPoint& collisionPoint, btCollisionObject
 export class PhysicsWrapper
 {
 private:
+	/**
+	 * @brief Scheduler of the multithreaded world, empty when the physics runs on the main thread.
+	 * @note Declared first, so that it outlives the world.
+	*/
+	unique_ptr<JobTaskScheduler> mTaskScheduler;
+
 	/**
 	 * @brief The physics world handler.
 	*/
@@ -47,21 +306,695 @@ private:
 	 * @brief Gravity constant.
 	*/
 	btVector3 const mGravity = btVector3(0, -10.f, 0);
+
+	/**
+	 * @brief Collision layers from the configuration. Bodies without a layer use the default Bullet filters.
+	*/
+	std::vector<CollisionLayer> mLayers;
+
+	/**
+	 * @brief Packed entity pairs in contact during the last step, sorted.
+	*/
+	std::vector<std::uint64_t> mCurrentPairs;
+
+	/**
+	 * @brief Packed entity pairs in contact during the step before.
+	*/
+	std::vector<std::uint64_t> mPreviousPairs;
+
+	/**
+	 * @brief Contact changes of the last step.
+	*/
+	ContactEvents mContacts;
+
+	/**
+	 * @brief Counters of the last step.
+	*/
+	PhysicsStepStats mStepStats;
+
+	/**
+	 * @brief Island tags of the last step, kept to not allocate them every step.
+	*/
+	std::vector<int> mIslandTags;
+
+	/**
+	 * @brief Shapes by their description key, shared by every body that uses the same collider.
+	*/
+	std::unordered_map<std::string, std::shared_ptr<btCollisionShape>> mShapeCache;
+
+	/**
+	 * @brief Provides the triangles of a mesh for the convex hulls and the triangle meshes.
+	*/
+	std::function<MeshGeometry(std::string const&)> mMeshSource;
+
+	/**
+	 * @brief Get the path of the baked BVH of a mesh.
+	*/
+	static inline std::string GetBakedBvhPath(std::string const& meshPath)
+	{
+		return meshPath + ".bvh";
+	}
+
+	/**
+	 * @brief FNV-1a hash of the triangles.
+	*/
+	static std::uint64_t HashGeometry(MeshGeometry const& geometry)
+	{
+		std::uint64_t hash = 14695981039346656037ull;
+		auto hashBytes = [&hash](void const* data, size_t const size)
+		{
+			auto bytes = (unsigned char const*)data;
+			for (size_t i = 0; i < size; i++)
+				hash = (hash ^ bytes[i]) * 1099511628211ull;
+		};
+
+		hashBytes(geometry.mVertices.data(), geometry.mVertices.size() * sizeof(yamath::Vec3D));
+		hashBytes(geometry.mIndices.data(), geometry.mIndices.size() * sizeof(int));
+		return hash;
+	}
+
+	/**
+	 * @brief Load the baked BVH into the aligned buffer of the mesh data.
+	 * @return Null if there is no baked file, or it was baked from different triangles.
+	*/
+	static btOptimizedBvh* LoadBakedBvh(std::string const& path, std::uint64_t const geometryHash, TriangleMeshData& data)
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (file.fail())
+			return nullptr;
+
+		BakedBvhHeader expected, header;
+		file.read((char*)&header, sizeof(header));
+		if (!file || !std::equal(std::begin(header.mMagic), std::end(header.mMagic), std::begin(expected.mMagic)) || header.mVersion != expected.mVersion)
+		{
+			Log(LGR_WARNING, std::format("Baked BVH at \"{}\" is not valid or was baked by a different version", path));
+			return nullptr;
+		}
+
+		if (header.mGeometryHash != geometryHash)
+		{
+			Log(LGR_WARNING, std::format("Baked BVH at \"{}\" does not match its mesh anymore", path));
+			return nullptr;
+		}
+
+		// The tree is used straight from the buffer, which has to be 16 byte aligned and stay alive with the shape.
+		data.mBvhBuffer = btAlignedAlloc(header.mBvhSize, 16);
+		file.read((char*)data.mBvhBuffer, header.mBvhSize);
+		if (!file)
+			return nullptr;
+
+		return btOptimizedBvh::deSerializeInPlace(data.mBvhBuffer, header.mBvhSize, false);
+	}
+
+	/**
+	 * @brief Save the BVH so that the next load can skip building it.
+	*/
+	static bool SaveBakedBvh(std::string const& path, std::uint64_t const geometryHash, btOptimizedBvh const& bvh)
+	{
+		BakedBvhHeader header;
+		header.mGeometryHash = geometryHash;
+		header.mBvhSize = bvh.calculateSerializeBufferSize();
+
+		auto buffer = btAlignedAlloc(header.mBvhSize, 16);
+		bool serialized = bvh.serializeInPlace(buffer, header.mBvhSize, false);
+
+		std::ofstream file(path, std::ios::binary);
+		if (serialized && !file.fail())
+		{
+			file.write((char const*)&header, sizeof(header));
+			file.write((char const*)buffer, header.mBvhSize);
+		}
+		btAlignedFree(buffer);
+
+		if (!serialized || !file)
+		{
+			Log(LGR_ERROR, std::format("Could not save the baked BVH to \"{}\"", path));
+			return false;
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Create an unscaled triangle mesh shape, using the baked BVH if there is a valid one.
+	 * @param meshPath
+	 * @param rebake Build the BVH and save it even if there is a baked one.
+	 * @param saved Set to true if the BVH was built and saved.
+	 * @return Empty if the mesh has no triangles.
+	*/
+	std::shared_ptr<btCollisionShape> CreateTriangleMesh(std::string const& meshPath, bool const rebake, bool* saved = nullptr)
+	{
+		auto data = std::make_shared<TriangleMeshData>();
+		if (mMeshSource)
+			data->mGeometry = mMeshSource(meshPath);
+
+		auto& geometry = data->mGeometry;
+		if (geometry.mIndices.size() < 3 || geometry.mVertices.empty())
+		{
+			Log(LGR_ERROR, std::format("Could not get the triangles of \"{}\" for the triangle mesh", meshPath));
+			return {};
+		}
+
+		btIndexedMesh indexedMesh;
+		indexedMesh.m_numTriangles = (int)geometry.mIndices.size() / 3;
+		indexedMesh.m_triangleIndexBase = (unsigned char const*)geometry.mIndices.data();
+		indexedMesh.m_triangleIndexStride = 3 * sizeof(int);
+		indexedMesh.m_numVertices = (int)geometry.mVertices.size();
+		indexedMesh.m_vertexBase = (unsigned char const*)geometry.mVertices.data();
+		indexedMesh.m_vertexStride = sizeof(yamath::Vec3D);
+		indexedMesh.m_indexType = PHY_INTEGER;
+		indexedMesh.m_vertexType = PHY_FLOAT;
+
+		data->mMeshInterface = make_unique<btTriangleIndexVertexArray>();
+		data->mMeshInterface->addIndexedMesh(indexedMesh, PHY_INTEGER);
+
+		auto bakedPath = GetBakedBvhPath(meshPath);
+		auto geometryHash = HashGeometry(geometry);
+
+		// Quantized, as it takes a fraction of the memory and is what the baked file stores.
+		auto meshShape = new btBvhTriangleMeshShape(data->mMeshInterface.get(), true, false);
+		auto bakedBvh = rebake ? nullptr : LoadBakedBvh(bakedPath, geometryHash, *data);
+		if (bakedBvh)
+		{
+			meshShape->setOptimizedBvh(bakedBvh);
+		}
+		else
+		{
+			if (!rebake)
+				Log(LGR_WARNING, std::format("Triangle mesh \"{}\" was not baked, its BVH is built at load", meshPath));
+
+			meshShape->buildOptimizedBvh();
+			auto savedBvh = SaveBakedBvh(bakedPath, geometryHash, *meshShape->getOptimizedBvh());
+			if (saved)
+				*saved = savedBvh;
+		}
+
+		return std::shared_ptr<btCollisionShape>(meshShape, [data](btCollisionShape* bvhShape) { delete bvhShape; });
+	}
+
+	/**
+	 * @brief Create a key that is the same for the equal shape descriptions.
+	*/
+	static std::string GetShapeKey(ShapeDescription const& shape)
+	{
+		switch (shape.mType)
+		{
+		case Box:
+			return std::format("Box {} {} {}", shape.mExtents.X, shape.mExtents.Y, shape.mExtents.Z);
+		case Sphere:
+			return std::format("Sphere {}", shape.mRadius);
+		case Capsule:
+			return std::format("Capsule {} {}", shape.mRadius, shape.mHeight);
+		case ConvexHull:
+			return std::format("ConvexHull {} {} {} {}", shape.mScale.X, shape.mScale.Y, shape.mScale.Z, shape.mMeshPath);
+		case TriangleMesh:
+			return std::format("TriangleMesh {} {} {} {}", shape.mScale.X, shape.mScale.Y, shape.mScale.Z, shape.mMeshPath);
+		case Compound:
+		{
+			std::string key = "Compound(";
+			for (auto const& child : shape.mChildren)
+			{
+				auto const& rot = child.mRotation;
+				key += std::format("{} at {} {} {} {} {} {} {};", GetShapeKey(child.mShape), child.mOffset.X, child.mOffset.Y, child.mOffset.Z, rot.X, rot.Y, rot.Z, rot.W);
+			}
+			return key + ")";
+		}
+		default:
+			return "Empty";
+		}
+	}
+
+	/**
+	 * @brief Create a new shape from the description.
+	 * @return Empty if the description is not valid.
+	*/
+	std::shared_ptr<btCollisionShape> CreateShape(ShapeDescription const& shape)
+	{
+		switch (shape.mType)
+		{
+		case Box:
+			return std::shared_ptr<btCollisionShape>(new btBoxShape(btVector3(shape.mExtents.X, shape.mExtents.Y, shape.mExtents.Z)));
+		case Sphere:
+			return std::shared_ptr<btCollisionShape>(new btSphereShape(shape.mRadius));
+		case Capsule:
+			return std::shared_ptr<btCollisionShape>(new btCapsuleShape(shape.mRadius, shape.mHeight));
+		case ConvexHull:
+		{
+			auto vertices = mMeshSource ? mMeshSource(shape.mMeshPath).mVertices : std::vector<yamath::Vec3D>();
+			if (vertices.empty())
+			{
+				Log(LGR_ERROR, std::format("Could not get the vertices of \"{}\" for the convex hull", shape.mMeshPath));
+				return {};
+			}
+
+			auto hull = new btConvexHullShape(&vertices[0].X, (int)vertices.size(), sizeof(yamath::Vec3D));
+			hull->setLocalScaling(btVector3(shape.mScale.X, shape.mScale.Y, shape.mScale.Z));
+			// Meshes have many vertices inside of the hull, which would only slow down the collision checks.
+			hull->optimizeConvexHull();
+			hull->recalcLocalAabb();
+			return std::shared_ptr<btCollisionShape>(hull);
+		}
+		case Compound:
+		{
+			if (shape.mChildren.empty())
+			{
+				Log(LGR_ERROR, "Compound collider has no children");
+				return {};
+			}
+
+			// The compound only keeps raw pointers to the children, so the deleter holds on to them.
+			std::vector<std::shared_ptr<btCollisionShape>> children;
+			auto compound = new btCompoundShape(true, (int)shape.mChildren.size());
+			for (auto const& child : shape.mChildren)
+			{
+				if (child.mShape.mType == TriangleMesh)
+				{
+					Log(LGR_ERROR, "Triangle meshes can not be a part of a compound collider");
+					continue;
+				}
+
+				auto childShape = GetShape(child.mShape);
+				if (!childShape)
+					continue;
+
+				auto const& rot = child.mRotation;
+				btTransform childTransform(btQuaternion(rot.X, rot.Y, rot.Z, rot.W), btVector3(child.mOffset.X, child.mOffset.Y, child.mOffset.Z));
+				compound->addChildShape(childTransform, childShape.get());
+				children.push_back(std::move(childShape));
+			}
+
+			if (children.empty())
+			{
+				delete compound;
+				return {};
+			}
+
+			return std::shared_ptr<btCollisionShape>(compound, [children = std::move(children)](btCollisionShape* compoundShape) { delete compoundShape; });
+		}
+		case TriangleMesh:
+		{
+			if (shape.mScale.X == 1 && shape.mScale.Y == 1 && shape.mScale.Z == 1)
+				return CreateTriangleMesh(shape.mMeshPath, false);
+
+			// The scaled shape wraps the unscaled one, so every scale of the mesh shares the same BVH.
+			ShapeDescription unscaled = shape;
+			unscaled.mScale = { 1, 1, 1 };
+			auto meshShape = GetShape(unscaled);
+			if (!meshShape)
+				return {};
+
+			auto scaled = new btScaledBvhTriangleMeshShape((btBvhTriangleMeshShape*)meshShape.get(), btVector3(shape.mScale.X, shape.mScale.Y, shape.mScale.Z));
+			return std::shared_ptr<btCollisionShape>(scaled, [meshShape](btCollisionShape* scaledShape) { delete scaledShape; });
+		}
+		default:
+			Log(LGR_ERROR, "Collider has no shape");
+			return {};
+		}
+	}
+
+	/**
+	 * @brief Pack an entity pair into a single sortable key, lower ID first.
+	*/
+	static inline std::uint64_t PackPair(int const first, int const second)
+	{
+		auto [low, high] = std::minmax(first, second);
+		return ((std::uint64_t)(std::uint32_t)low << 32) | (std::uint32_t)high;
+	}
+
+	/**
+	 * @brief Unpack a key created by PackPair.
+	*/
+	static inline ContactPair UnpackPair(std::uint64_t const key)
+	{
+		return ContactPair{ (int)(std::uint32_t)(key >> 32), (int)(std::uint32_t)key };
+	}
+
+	/**
+	 * @brief Get the entity of a merged collider child.
+	 * @return -1 if the index is not a child.
+	*/
+	static inline int GetChildEntity(std::vector<int> const& childEntities, int const childIndex)
+	{
+		return childIndex >= 0 && childIndex < (int)childEntities.size() ? childEntities[childIndex] : -1;
+	}
+
+	/**
+	 * @brief Minimal amount of queries per job.
+	*/
+	static constexpr size_t QueryBatchSize = 16;
+
+	/**
+	 * @brief Check if a query can hit the collision object. Triggers and the entity of the query are never hit.
+	*/
+	static inline bool CanQueryHit(btCollisionObject const* object, int const entity, int const mask)
+	{
+		if (object->getCollisionFlags() & btCollisionObject::CF_NO_CONTACT_RESPONSE)
+			return false;
+
+		if (entity >= 0 && object->getUserIndex() == entity)
+			return false;
+
+		return (object->getBroadphaseHandle()->m_collisionFilterGroup & mask) != 0;
+	}
+
+	/**
+	 * @brief Get the entity of a hit collision object.
+	 * @param childIndex Hit compound child, picks the entity of merged static colliders.
+	*/
+	static inline int GetHitEntity(btCollisionObject const* object, int const childIndex)
+	{
+		auto children = (std::vector<int> const*)object->getUserPointer();
+		return children ? GetChildEntity(*children, childIndex) : object->getUserIndex();
+	}
+
+	/**
+	 * @brief Call the function with every collision object whose broad-phase bounds the ray goes through.
+	*/
+	template<typename Function>
+	void ForEachRayCandidate(btVector3 const& from, btVector3 const& to, Function&& function) const
+	{
+		LeafCollector<Function> collector(function);
+		// The moving and the resting proxies are kept in separate trees.
+		for (auto const& tree : ((btDbvtBroadphase*)mBroadphase.get())->m_sets)
+			btDbvt::rayTest(tree.m_root, from, to, collector);
+	}
+
+	/**
+	 * @brief Call the function with every collision object whose broad-phase bounds overlap with the box.
+	*/
+	template<typename Function>
+	void ForEachBoundsCandidate(btVector3 const& min, btVector3 const& max, Function&& function) const
+	{
+		LeafCollector<Function> collector(function);
+		auto bounds = btDbvtVolume::FromMM(min, max);
+		for (auto const& tree : ((btDbvtBroadphase*)mBroadphase.get())->m_sets)
+			tree.collideTV(tree.m_root, bounds, collector);
+	}
+
+	/**
+	 * @brief Find the closest hit of a ray.
+	*/
+	QueryHit CastRay(RayQuery const& query) const
+	{
+		btVector3 from(query.mFrom.X, query.mFrom.Y, query.mFrom.Z), to(query.mTo.X, query.mTo.Y, query.mTo.Z);
+		btTransform fromTransform(btQuaternion::getIdentity(), from), toTransform(btQuaternion::getIdentity(), to);
+
+		ChildRayCallback callback(from, to);
+		ForEachRayCandidate(from, to, [&](btCollisionObject* object)
+							{
+								if (CanQueryHit(object, query.mEntity, query.mMask))
+									btCollisionWorld::rayTestSingle(fromTransform, toTransform, object, object->getCollisionShape(), object->getWorldTransform(), callback);
+							});
+
+		QueryHit hit;
+		if (callback.hasHit())
+		{
+			auto const& point = callback.m_hitPointWorld;
+			auto const& normal = callback.m_hitNormalWorld;
+			hit.mEntity = GetHitEntity(callback.m_collisionObject, callback.mChildIndex);
+			hit.mPoint = { point.getX(), point.getY(), point.getZ() };
+			hit.mNormal = { normal.getX(), normal.getY(), normal.getZ() };
+			hit.mFraction = callback.m_closestHitFraction;
+		}
+		return hit;
+	}
+
+	/**
+	 * @brief Find the closest hit of a swept shape.
+	*/
+	QueryHit CastSweep(SweepQuery const& query, btConvexShape const* shape) const
+	{
+		btQuaternion rotation(query.mRotation.X, query.mRotation.Y, query.mRotation.Z, query.mRotation.W);
+		btVector3 from(query.mFrom.X, query.mFrom.Y, query.mFrom.Z), to(query.mTo.X, query.mTo.Y, query.mTo.Z);
+		btTransform fromTransform(rotation, from), toTransform(rotation, to);
+
+		// Bounds of the whole sweep.
+		btVector3 fromMin, fromMax, toMin, toMax;
+		shape->getAabb(fromTransform, fromMin, fromMax);
+		shape->getAabb(toTransform, toMin, toMax);
+		fromMin.setMin(toMin);
+		fromMax.setMax(toMax);
+
+		ChildConvexCallback callback(from, to);
+		ForEachBoundsCandidate(fromMin, fromMax, [&](btCollisionObject* object)
+							   {
+								   if (CanQueryHit(object, query.mEntity, query.mMask))
+									   btCollisionWorld::objectQuerySingle(shape, fromTransform, toTransform, object, object->getCollisionShape(), object->getWorldTransform(), callback, 0);
+							   });
+
+		QueryHit hit;
+		if (callback.hasHit())
+		{
+			auto const& point = callback.m_hitPointWorld;
+			auto const& normal = callback.m_hitNormalWorld;
+			hit.mEntity = GetHitEntity(callback.m_hitCollisionObject, callback.mChildIndex);
+			hit.mPoint = { point.getX(), point.getY(), point.getZ() };
+			hit.mNormal = { normal.getX(), normal.getY(), normal.getZ() };
+			hit.mFraction = callback.m_closestHitFraction;
+		}
+		return hit;
+	}
+
+	/**
+	 * @brief Find the entities that overlap with a shape.
+	 * @return Sorted entities without duplicates.
+	*/
+	std::vector<int> FindOverlaps(OverlapQuery const& query, btConvexShape const* shape) const
+	{
+		btTransform transform(btQuaternion(query.mRotation.X, query.mRotation.Y, query.mRotation.Z, query.mRotation.W), btVector3(query.mPosition.X, query.mPosition.Y, query.mPosition.Z));
+		btVector3 min, max;
+		shape->getAabb(transform, min, max);
+
+		std::vector<int> entities;
+		ForEachBoundsCandidate(min, max, [&](btCollisionObject* object)
+							   {
+								   if (!CanQueryHit(object, query.mEntity, query.mMask))
+									   return;
+
+								   auto const& objectTransform = object->getWorldTransform();
+								   auto children = (std::vector<int> const*)object->getUserPointer();
+								   if (!children)
+								   {
+									   if (object->getUserIndex() >= 0 && ConvexOverlaps(shape, transform, object->getCollisionShape(), objectTransform))
+										   entities.push_back(object->getUserIndex());
+									   return;
+								   }
+
+								   // Merged static colliders report every touched child.
+								   auto compound = (btCompoundShape const*)object->getCollisionShape();
+								   for (int i = 0; i < compound->getNumChildShapes(); i++)
+								   {
+									   auto entity = GetChildEntity(*children, i);
+									   if (entity >= 0 && entity != query.mEntity && ConvexOverlaps(shape, transform, compound->getChildShape(i), objectTransform * compound->getChildTransform(i)))
+										   entities.push_back(entity);
+								   }
+							   });
+
+		std::sort(entities.begin(), entities.end());
+		entities.erase(std::unique(entities.begin(), entities.end()), entities.end());
+		return entities;
+	}
+
+	/**
+	 * @brief Get the shapes of the queries. Has to be done before they run in parallel, as the shape cache is not thread safe.
+	 * @return Null for the queries whose shape is not convex.
+	*/
+	template<typename Query>
+	std::vector<std::shared_ptr<btCollisionShape>> GetQueryShapes(std::vector<Query> const& queries)
+	{
+		std::vector<std::shared_ptr<btCollisionShape>> shapes;
+		shapes.reserve(queries.size());
+		for (auto const& query : queries)
+		{
+			auto shape = GetShape(query.mShape);
+			if (shape && !shape->isConvex())
+			{
+				Log(LGR_ERROR, std::format("Query of entity {} has a shape that is not convex, it is skipped", query.mEntity));
+				shape.reset();
+			}
+			shapes.push_back(std::move(shape));
+		}
+		return shapes;
+	}
+
+	/**
+	 * @brief Create a rigid body with the shape and add it to the world.
+	*/
+	PhysicalBody CreateRigidBody(std::shared_ptr<btCollisionShape>&& collisionShape, ColliderShape const type, float mass, yamath::Vec3D const& offset, int const entityID, int const layer, bool const kinematic)
+	{
+		if (kinematic)
+			mass = 0;
+
+		btVector3 inertia(0, 0, 0);
+		if (mass != 0)
+			collisionShape->calculateLocalInertia(mass, inertia);
+
+		btTransform t;
+		t.setIdentity();
+		// An obviously unrealistic position. As it will be replaced later either way, this is going to be a good indicator if position is not being set properly
+		t.setOrigin(btVector3(777, 777, 777));
+		PhysicalBody body(mWorld.get());
+		body.mMotionState = make_unique<EntityMotionState>(t);
+		body.mMotionState->mOffset = offset;
+
+		btRigidBody::btRigidBodyConstructionInfo rbInfo(mass, body.mMotionState.get(), collisionShape.get());
+		body.mShape = type;
+		body.mBody = make_unique<btRigidBody>(rbInfo);
+		body.mCollisionShape = std::move(collisionShape);
+
+		if (kinematic)
+		{
+			// Kinematic bodies have to stay awake, as Bullet only reads the motion state of the active ones.
+			body.mBody->setCollisionFlags(body.mBody->getCollisionFlags() | btCollisionObject::CF_KINEMATIC_OBJECT);
+			body.mBody->setActivationState(DISABLE_DEACTIVATION);
+		}
+
+		// Store the entity so it can be retrieved from the contact manifolds
+		body.mBody->setUserIndex(entityID);
+		body.mOffset = offset;
+		body.entityId = entityID;
+
+		if (layer >= 0 && layer < (int)mLayers.size())
+			mWorld->addRigidBody(body.mBody.get(), mLayers[layer].mGroup, mLayers[layer].mMask);
+		else
+			mWorld->addRigidBody(body.mBody.get());
+		return body;
+	}
+
+	/**
+	 * @brief Count the awake and sleeping bodies and the islands they are in.
+	*/
+	void UpdateBodyStats()
+	{
+		mIslandTags.clear();
+		auto& objects = mWorld->getCollisionObjectArray();
+		for (int i = 0; i < objects.size(); i++)
+		{
+			auto body = btRigidBody::upcast(objects[i]);
+			if (!body || body->isStaticObject())
+				continue;
+
+			if (body->isActive())
+				mStepStats.mActiveBodies++;
+			else
+				mStepStats.mSleepingBodies++;
+
+			// Static and kinematic bodies are not a part of any island.
+			if (body->getIslandTag() >= 0)
+				mIslandTags.push_back(body->getIslandTag());
+		}
+
+		std::sort(mIslandTags.begin(), mIslandTags.end());
+		mStepStats.mIslands = (unsigned int)(std::unique(mIslandTags.begin(), mIslandTags.end()) - mIslandTags.begin());
+	}
+
+	/**
+	 * @brief Collect the pairs from the contact manifolds and compare them against the previous step.
+	*/
+	void UpdateContacts()
+	{
+		std::swap(mCurrentPairs, mPreviousPairs);
+		mCurrentPairs.clear();
+
+		for (int i = 0, count = mDispatcher->getNumManifolds(); i < count; i++)
+		{
+			auto manifold = mDispatcher->getManifoldByIndexInternal(i);
+			mStepStats.mContactPoints += manifold->getNumContacts();
+			if (manifold->getNumContacts() == 0)
+				continue;
+
+			auto body0 = manifold->getBody0();
+			auto body1 = manifold->getBody1();
+			auto firstChildren = (std::vector<int> const*)body0->getUserPointer();
+			auto secondChildren = (std::vector<int> const*)body1->getUserPointer();
+
+			if (!firstChildren && !secondChildren)
+			{
+				auto first = body0->getUserIndex();
+				auto second = body1->getUserIndex();
+				if (first >= 0 && second >= 0)
+					mCurrentPairs.push_back(PackPair(first, second));
+				continue;
+			}
+
+			// Merged static colliders are a single body, the touched child is in the contact points.
+			for (int point = 0; point < manifold->getNumContacts(); point++)
+			{
+				auto const& contact = manifold->getContactPoint(point);
+				auto first = firstChildren ? GetChildEntity(*firstChildren, contact.m_index0) : body0->getUserIndex();
+				auto second = secondChildren ? GetChildEntity(*secondChildren, contact.m_index1) : body1->getUserIndex();
+				if (first >= 0 && second >= 0)
+					mCurrentPairs.push_back(PackPair(first, second));
+			}
+		}
+
+		// A pair can have multiple manifolds, e.g. with compound shapes.
+		std::sort(mCurrentPairs.begin(), mCurrentPairs.end());
+		mCurrentPairs.erase(std::unique(mCurrentPairs.begin(), mCurrentPairs.end()), mCurrentPairs.end());
+
+		mContacts.mEntered.clear();
+		mContacts.mStayed.clear();
+		mContacts.mExited.clear();
+
+		// Both arrays are sorted, so a single merge pass splits them into new, kept and lost pairs.
+		size_t current = 0, previous = 0;
+		while (current < mCurrentPairs.size() || previous < mPreviousPairs.size())
+		{
+			if (previous == mPreviousPairs.size() || (current < mCurrentPairs.size() && mCurrentPairs[current] < mPreviousPairs[previous]))
+				mContacts.mEntered.push_back(UnpackPair(mCurrentPairs[current++]));
+			else if (current == mCurrentPairs.size() || mPreviousPairs[previous] < mCurrentPairs[current])
+				mContacts.mExited.push_back(UnpackPair(mPreviousPairs[previous++]));
+			else
+			{
+				mContacts.mStayed.push_back(UnpackPair(mCurrentPairs[current]));
+				current++;
+				previous++;
+			}
+		}
+	}
 public:
-	PhysicsWrapper()
+	/**
+	 * @brief Create the physics world.
+	 * @param threadCount Amount of threads for the simulation. Above 1 the multithreaded world is used, which needs the job system to be started first.
+	*/
+	explicit PhysicsWrapper(int const threadCount = 1)
 	{
 		mCollisionConfig = make_unique<btDefaultCollisionConfiguration>();
-		mDispatcher = make_unique<btCollisionDispatcher>(mCollisionConfig.get());
 		mBroadphase = make_unique<btDbvtBroadphase>();
-		mSolver = make_unique<btSequentialImpulseConstraintSolver>(); // should be able to be used with openCL to improve the performance
 
-		mWorld = make_unique<btDiscreteDynamicsWorld>(mDispatcher.get(), mBroadphase.get(), mSolver.get(), mCollisionConfig.get());
-		mWorld->setGravity(mGravity);
+		if (threadCount > 1 && JobSystem::Instance().GetThreadCount() > 1)
+		{
+			// The scheduler has to be set before the Mt classes are created, as they size their per thread data by it.
+			mTaskScheduler = make_unique<JobTaskScheduler>(threadCount);
+			btSetTaskScheduler(mTaskScheduler.get());
+
+			mDispatcher = make_unique<btCollisionDispatcherMt>(mCollisionConfig.get());
+			auto solverPool = make_unique<btConstraintSolverPoolMt>(mTaskScheduler->getNumThreads());
+			mWorld = make_unique<btDiscreteDynamicsWorldMt>(mDispatcher.get(), mBroadphase.get(), solverPool.get(), nullptr, mCollisionConfig.get());
+			mSolver = std::move(solverPool);
+
+			Log(LGR_INFO, std::format("Physics runs on up to {} threads", std::min(threadCount, mTaskScheduler->getMaxNumThreads())));
+		}
+		else
+		{
+			if (threadCount > 1)
+				Log(LGR_WARNING, "Multithreaded physics needs the job system worker threads, the physics runs on the main thread");
 
-		gContactAddedCallback = collisionStartedCallback;
+			mDispatcher = make_unique<btCollisionDispatcher>(mCollisionConfig.get());
+			mSolver = make_unique<btSequentialImpulseConstraintSolver>(); // should be able to be used with openCL to improve the performance
+			mWorld = make_unique<btDiscreteDynamicsWorld>(mDispatcher.get(), mBroadphase.get(), mSolver.get(), mCollisionConfig.get());
+		}
+
+		mWorld->setGravity(mGravity);
 	}
 
-	~PhysicsWrapper() {}
+	~PhysicsWrapper()
+	{
+		if (mTaskScheduler)
+		{
+			mWorld.reset();
+			btSetTaskScheduler(btGetSequentialTaskScheduler());
+		}
+	}
 
 	/**
 	 * @brief Physics step update.
@@ -69,76 +1002,470 @@ public:
 	*/
 	void Update(float const& timeStep)
 	{
-		mWorld->stepSimulation(timeStep);
+		// The engine already accumulates the fixed steps, so Bullet simulates exactly the given step instead of interpolating with its own 1/60.
+		auto subSteps = mWorld->stepSimulation(timeStep, 1, timeStep);
+
+		mStepStats = {};
+		mStepStats.mSolverIterations = subSteps * mWorld->getSolverInfo().m_numIterations;
+		mStepStats.mBroadphasePairs = mBroadphase->getOverlappingPairCache()->getNumOverlappingPairs();
+		mStepStats.mManifolds = mDispatcher->getNumManifolds();
+		UpdateBodyStats();
+		UpdateContacts();
+	}
+
+	/**
+	 * @brief Get the counters of the last step.
+	*/
+	inline PhysicsStepStats const& GetStepStats() const noexcept
+	{
+		return mStepStats;
+	}
+
+	/**
+	 * @brief Get the contact changes of the last physics step.
+	*/
+	inline ContactEvents const& GetContacts() const noexcept
+	{
+		return mContacts;
+	}
+
+	/**
+	 * @brief Forget the tracked contacts, e.g. when the scene is changed and the entity IDs get reused.
+	*/
+	inline void ClearContacts() noexcept
+	{
+		mCurrentPairs.clear();
+		mPreviousPairs.clear();
+		mContacts.mEntered.clear();
+		mContacts.mStayed.clear();
+		mContacts.mExited.clear();
+	}
+
+	/**
+	 * @brief Set the collision layers. Has to be done before the bodies are created.
+	 * @param layers
+	*/
+	inline void SetCollisionLayers(std::vector<CollisionLayer>&& layers)
+	{
+		mLayers = std::move(layers);
+	}
+
+	/**
+	 * @brief Find the index of a collision layer by its name.
+	 * @param name
+	 * @return -1 if there is no such layer.
+	*/
+	inline int FindCollisionLayer(std::string const& name) const
+	{
+		for (size_t i = 0; i < mLayers.size(); i++)
+		{
+			if (mLayers[i].mName == name)
+				return (int)i;
+		}
+		return -1;
 	}
 
 	/**
-	 * @brief Create a cube shape collider.
-	 * @param extents Half dimensions.
+	 * @brief Count the broad-phase pairs per layer combination.
+	 * @note Goes through every overlapping pair, so it is meant for the statistics only.
+	 * @return Layer pair names, e.g. "Player-Static", and their pair counts. Combinations without pairs are left out.
+	*/
+	std::vector<std::pair<std::string, unsigned int>> CountLayerPairs() const
+	{
+		// The last slot is for the bodies without a layer.
+		auto slots = mLayers.size() + 1;
+		std::vector<unsigned int> counts(slots * slots, 0);
+
+		auto layerSlot = [this](btBroadphaseProxy const* proxy)
+		{
+			auto index = (size_t)std::countr_zero((unsigned int)proxy->m_collisionFilterGroup);
+			return index < mLayers.size() && mLayers[index].mGroup == proxy->m_collisionFilterGroup ? index : mLayers.size();
+		};
+
+		auto& pairs = mBroadphase->getOverlappingPairCache()->getOverlappingPairArray();
+		for (int i = 0; i < pairs.size(); i++)
+		{
+			auto [low, high] = std::minmax(layerSlot(pairs[i].m_pProxy0), layerSlot(pairs[i].m_pProxy1));
+			counts[low * slots + high]++;
+		}
+
+		auto slotName = [this](size_t const slot) { return slot < mLayers.size() ? mLayers[slot].mName : std::string("None"); };
+
+		std::vector<std::pair<std::string, unsigned int>> result;
+		for (size_t low = 0; low < slots; low++)
+		{
+			for (size_t high = low; high < slots; high++)
+			{
+				if (counts[low * slots + high] > 0)
+					result.emplace_back(slotName(low) + "-" + slotName(high), counts[low * slots + high]);
+			}
+		}
+		return result;
+	}
+
+	/**
+	 * @brief Set the function that provides the mesh triangles for the convex hull and triangle mesh colliders.
+	 * @param meshSource Called with the mesh path, returns the triangles or empty if the mesh could not be loaded.
+	*/
+	inline void SetMeshSource(std::function<MeshGeometry(std::string const&)>&& meshSource)
+	{
+		mMeshSource = std::move(meshSource);
+	}
+
+	/**
+	 * @brief Get a shape from the cache, creating it if there is none with the same description.
+	 * @param shape
+	 * @return Empty if the shape could not be created.
+	*/
+	std::shared_ptr<btCollisionShape> GetShape(ShapeDescription const& shape)
+	{
+		auto key = GetShapeKey(shape);
+		auto found = mShapeCache.find(key);
+		if (found != mShapeCache.end())
+			return found->second;
+
+		auto created = CreateShape(shape);
+		if (created)
+			mShapeCache.emplace(std::move(key), created);
+		return created;
+	}
+
+	/**
+	 * @brief Remove the shapes that are not used by any body from the cache, e.g. after a scene is loaded.
+	 * @note Compound children are kept for as long as their compound is.
+	*/
+	void ReleaseUnusedShapes()
+	{
+		// A compound holds its children, so the compounds have to be released before the children can be seen as unused.
+		bool released = true;
+		while (released)
+		{
+			released = std::erase_if(mShapeCache, [](auto const& entry) { return entry.second.use_count() == 1; }) > 0;
+		}
+	}
+
+	/**
+	 * @brief Build the BVH of a triangle mesh and save it next to the mesh, so that loading the collider does not have to build it.
+	 * @param meshPath
+	 * @return False if the mesh could not be loaded or the BVH could not be saved.
+	*/
+	bool BakeTriangleMesh(std::string const& meshPath)
+	{
+		bool saved = false;
+		if (!CreateTriangleMesh(meshPath, true, &saved) || !saved)
+			return false;
+
+		Log(LGR_INFO, std::format("Baked the BVH of \"{}\" into \"{}\"", meshPath, GetBakedBvhPath(meshPath)));
+		return true;
+	}
+
+	/**
+	 * @brief Get the amount of shapes in the cache.
+	*/
+	inline size_t GetCachedShapeCount() const noexcept
+	{
+		return mShapeCache.size();
+	}
+
+	/**
+	 * @brief Create a rigid body collider.
+	 * @param shape
 	 * @param mass
 	 * @param offset
 	 * @param entityID
-	 * @return
+	 * @param layer Index of the collision layer, -1 for the default Bullet filters.
+	 * @param kinematic Make the body move only by the scripts, while still pushing the dynamic bodies. The mass is ignored.
+	 * @return Empty if the shape could not be created.
 	*/
-	PhysicalBody CreatePhysicsCube(yamath::Vec3D const& extents, float const& mass = 0, yamath::Vec3D const& offset = { 0, 0, 0 }, int const& entityID = -1) const
+	std::optional<PhysicalBody> CreatePhysicsBody(ShapeDescription const& shape, float mass = 0, yamath::Vec3D const& offset = { 0, 0, 0 }, int const& entityID = -1, int const layer = -1, bool kinematic = false)
 	{
-		btVector3 btDimensions(
-			extents.X,
-			extents.Y,
-			extents.Z);
+		auto collisionShape = GetShape(shape);
+		if (!collisionShape)
+			return {};
 
-		auto boxShape = new btBoxShape(btDimensions);
+		// Bullet can not simulate a moving triangle mesh, it can only be static.
+		if (shape.mType == TriangleMesh && (mass != 0 || kinematic))
+		{
+			Log(LGR_WARNING, std::format("Triangle mesh collider of entity {} is made static, as it can not move", entityID));
+			kinematic = false;
+			mass = 0;
+		}
 
-		// This can be moved to some private function as all shapes will have the same init after this point
-		btVector3 inertia(0, 0, 0);
-		if (mass != 0)
-			boxShape->calculateLocalInertia(mass, inertia);
+		return CreateRigidBody(std::move(collisionShape), shape.mType, mass, offset, entityID, layer, kinematic);
+	}
+
+	/**
+	 * @brief Create a single static body out of many static colliders, so that the broad-phase has one proxy instead of one per collider.
+	 * @note The contacts are still reported with the entities of the children. The body is placed at the origin, the children carry the entity transforms.
+	 * @param compound Compound description with a child per collider, each placed at its entity's transform.
+	 * @param childEntities Entity of every child, in the same order.
+	 * @param layer Index of the collision layer, -1 for the default Bullet filters.
+	 * @return Empty if a child could not be created.
+	*/
+	std::optional<PhysicalBody> CreateMergedStaticBody(ShapeDescription const& compound, std::vector<int>&& childEntities, int const layer = -1)
+	{
+		// Not cached, as no other body is made of the same colliders.
+		auto collisionShape = CreateShape(compound);
+		if (!collisionShape || ((btCompoundShape*)collisionShape.get())->getNumChildShapes() != (int)childEntities.size())
+		{
+			Log(LGR_ERROR, "Could not create every child of the merged static colliders");
+			return {};
+		}
+
+		auto body = CreateRigidBody(std::move(collisionShape), Compound, 0, { 0, 0, 0 }, -1, layer, false);
+		body.mChildEntities = make_unique<std::vector<int>>(std::move(childEntities));
+		body.mBody->setUserPointer(body.mChildEntities.get());
+		return body;
+	}
+
+	/**
+	 * @brief Remove the collider of an entity from the merged static colliders, so that a deleted entity does not leave an invisible wall behind.
+	 * @note Has to be called between the steps. A merged body without children is taken out of the world, its component still owns it.
+	 * @param entity
+	 * @return False if the entity has no merged collider.
+	*/
+	bool RemoveMergedChild(int const entity)
+	{
+		auto& objects = mWorld->getCollisionObjectArray();
+		for (int i = 0; i < objects.size(); i++)
+		{
+			auto object = objects[i];
+			auto children = (std::vector<int>*)object->getUserPointer();
+			if (!children)
+				continue;
+
+			auto found = std::find(children->begin(), children->end(), entity);
+			if (found == children->end())
+				continue;
+
+			// Bullet moves the last child into the removed index, so the entities are kept in the same order.
+			auto const childIndex = (int)(found - children->begin());
+			((btCompoundShape*)object->getCollisionShape())->removeChildShapeByIndex(childIndex);
+			*found = children->back();
+			children->pop_back();
+
+			// The cached pairs refer to the children by their old indexes.
+			mBroadphase->getOverlappingPairCache()->cleanProxyFromPairs(object->getBroadphaseHandle(), mDispatcher.get());
+			if (children->empty())
+				mWorld->removeCollisionObject(object);
+			else
+				mWorld->updateSingleAabb(object);
+			return true;
+		}
+
+		return false;
+	}
+
+	/**
+	 * @brief Create a trigger collider. Triggers report the overlaps as contacts, but do not take part in the constraint solving.
+	 * @param shape
+	 * @param offset
+	 * @param entityID
+	 * @param layer Index of the collision layer, -1 for the default Bullet sensor filters.
+	 * @return Empty if the shape could not be created.
+	*/
+	std::optional<PhysicalBody> CreateTrigger(ShapeDescription const& shape, yamath::Vec3D const& offset = { 0, 0, 0 }, int const& entityID = -1, int const layer = -1)
+	{
+		auto collisionShape = GetShape(shape);
+		if (!collisionShape)
+			return {};
 
 		btTransform t;
 		t.setIdentity();
-		// An obviously unrealistic position. As it will be replaced later either way, this is going to be a good indicator if position is not being set properly
+		// Same as with the rigid bodies, the position is replaced before the first step
 		t.setOrigin(btVector3(777, 777, 777));
-		auto motion = new btDefaultMotionState(t);
-		btRigidBody::btRigidBodyConstructionInfo rbInfo(mass, motion, boxShape);
-		PhysicalBody cube(mWorld.get());
-		cube.mShape = ColliderShape::Box;
-		cube.mBody = make_unique<btRigidBody>(rbInfo);
-		// Declare that the object collision will call custom callback
-		cube.mBody->setCollisionFlags(cube.mBody->getCollisionFlags() | btCollisionObject::CF_CUSTOM_MATERIAL_CALLBACK);
-
-		// Store the component so it can be retrieved from the collision
-		cube.mBody->setUserPointer(&cube);
-		cube.mOffset = offset;
-		cube.entityId = entityID;
-		mWorld->addRigidBody(cube.mBody.get());
-		return cube;
+
+		PhysicalBody trigger(mWorld.get());
+		trigger.mShape = shape.mType;
+		trigger.mTrigger = make_unique<btGhostObject>();
+		trigger.mTrigger->setCollisionShape(collisionShape.get());
+		trigger.mTrigger->setWorldTransform(t);
+		trigger.mCollisionShape = std::move(collisionShape);
+
+		// The narrow-phase still creates the contact manifolds, which is where the overlaps are read from, but no contact response means the solver skips them
+		trigger.mTrigger->setCollisionFlags(trigger.mTrigger->getCollisionFlags() | btCollisionObject::CF_NO_CONTACT_RESPONSE | btCollisionObject::CF_STATIC_OBJECT);
+		trigger.mTrigger->setUserIndex(entityID);
+		trigger.mOffset = offset;
+		trigger.entityId = entityID;
+
+		if (layer >= 0 && layer < (int)mLayers.size())
+			mWorld->addCollisionObject(trigger.mTrigger.get(), mLayers[layer].mGroup, mLayers[layer].mMask);
+		else
+			mWorld->addCollisionObject(trigger.mTrigger.get(), btBroadphaseProxy::SensorTrigger, btBroadphaseProxy::AllFilter ^ (btBroadphaseProxy::StaticFilter | btBroadphaseProxy::SensorTrigger));
+		return trigger;
 	}
-};
 
-/**
- * @brief Collision handling callback function.
- * @param collisionPoint
- * @param obj1
- * @param id1
- * @param index1
- * @param obj2
- * @param id2
- * @param index2
- * @return
-*/
-bool collisionStartedCallback(btManifoldPoint& collisionPoint, btCollisionObjectWrapper const* obj1, int id1, int index1, btCollisionObjectWrapper const* obj2, int id2, int index2)
-{
-	auto component1 = static_cast<PhysicalBody*>(obj1->m_collisionObject->getUserPointer());
-	auto component2 = static_cast<PhysicalBody*>(obj2->m_collisionObject->getUserPointer());
+	/**
+	 * @brief Capture the state of every body in the world.
+	 * @note Should be taken between the steps.
+	*/
+	PhysicsSnapshot CaptureSnapshot() const
+	{
+		PhysicsSnapshot snapshot;
+		auto& objects = mWorld->getCollisionObjectArray();
+		snapshot.mStates.reserve(objects.size());
 
-	auto comp1EntityId = component1->GetEntityId();
-	auto comp2EntityId = component2->GetEntityId();
+		for (int i = 0; i < objects.size(); i++)
+		{
+			auto object = objects[i];
+			auto const& origin = object->getWorldTransform().getOrigin();
+			auto const rotation = object->getWorldTransform().getRotation();
 
-	if (comp2EntityId > -1)
-		component1->AddIDToItemsCollidedWith(comp2EntityId);
+			BodyState state{ object, object->getUserIndex(), object->getActivationState(), object->getDeactivationTime(),
+				{ origin.getX(), origin.getY(), origin.getZ() }, { rotation.getX(), rotation.getY(), rotation.getZ(), rotation.getW() } };
 
-	if (comp1EntityId > -1)
-		component2->AddIDToItemsCollidedWith(comp1EntityId);
-	return false;
-}
-#endif // GAME
+			if (auto body = btRigidBody::upcast(object))
+			{
+				auto const& linear = body->getLinearVelocity();
+				auto const& angular = body->getAngularVelocity();
+				state.mLinearVelocity[0] = linear.getX();
+				state.mLinearVelocity[1] = linear.getY();
+				state.mLinearVelocity[2] = linear.getZ();
+				state.mAngularVelocity[0] = angular.getX();
+				state.mAngularVelocity[1] = angular.getY();
+				state.mAngularVelocity[2] = angular.getZ();
+			}
+			snapshot.mStates.push_back(state);
+		}
+
+		std::sort(snapshot.mStates.begin(), snapshot.mStates.end(), [](BodyState const& first, BodyState const& second) { return std::less<>()(first.mObject, second.mObject); });
+		return snapshot;
+	}
+
+	/**
+	 * @brief Put the bodies back into the state of the snapshot, without recreating them.
+	 * @note Has to be called between the steps. The bodies with a motion state report the move through it, while the triggers have to be read by the caller.
+	 The tracked contacts are forgotten, as they belong to the old positions.
+	 * @param snapshot
+	 * @return Amount of restored bodies.
+	*/
+	size_t RestoreSnapshot(PhysicsSnapshot const& snapshot)
+	{
+		auto const& states = snapshot.mStates;
+		auto& objects = mWorld->getCollisionObjectArray();
+		size_t restored = 0;
+
+		for (int i = 0; i < objects.size(); i++)
+		{
+			auto object = objects[i];
+			auto state = std::lower_bound(states.begin(), states.end(), object, [](BodyState const& current, btCollisionObject const* searched) { return std::less<>()(current.mObject, searched); });
+			if (state == states.end() || state->mObject != object || state->mEntity != object->getUserIndex())
+				continue;
+
+			btTransform transform(btQuaternion(state->mRotation[0], state->mRotation[1], state->mRotation[2], state->mRotation[3]),
+								  btVector3(state->mPosition[0], state->mPosition[1], state->mPosition[2]));
+			object->setWorldTransform(transform);
+			object->setInterpolationWorldTransform(transform);
+			object->forceActivationState(state->mActivationState);
+			object->setDeactivationTime(state->mDeactivationTime);
+
+			if (auto body = btRigidBody::upcast(object))
+			{
+				btVector3 linear(state->mLinearVelocity[0], state->mLinearVelocity[1], state->mLinearVelocity[2]);
+				btVector3 angular(state->mAngularVelocity[0], state->mAngularVelocity[1], state->mAngularVelocity[2]);
+				body->setLinearVelocity(linear);
+				body->setAngularVelocity(angular);
+				body->setInterpolationLinearVelocity(linear);
+				body->setInterpolationAngularVelocity(angular);
+				body->clearForces();
+
+				if (body->getMotionState())
+					body->getMotionState()->setWorldTransform(transform);
+			}
+
+			// The cached pairs still have the contact points of the old positions, which would push the bodies apart.
+			mWorld->updateSingleAabb(object);
+			mBroadphase->getOverlappingPairCache()->cleanProxyFromPairs(object->getBroadphaseHandle(), mDispatcher.get());
+			restored++;
+		}
+
+		ClearContacts();
+		return restored;
+	}
+
+	/**
+	 * @brief Cast a batch of rays in parallel.
+	 * @note Has to be called between the steps, as it reads the world while the job system runs the rays.
+	 * @param queries
+	 * @param hits Closest hit of every ray, in the same order.
+	*/
+	void RayTest(std::vector<RayQuery> const& queries, std::vector<QueryHit>& hits) const
+	{
+		hits.resize(queries.size());
+		JobSystem::Instance().ParallelFor(queries.size(), QueryBatchSize, [this, &queries, &hits](size_t start, size_t end)
+										  {
+											  for (size_t i = start; i < end; i++)
+												  hits[i] = CastRay(queries[i]);
+										  });
+	}
+
+	/**
+	 * @brief Sweep a batch of convex shapes in parallel.
+	 * @note Has to be called between the steps, as it reads the world while the job system runs the sweeps.
+	 * @param queries
+	 * @param hits Closest hit of every sweep, in the same order. Sweeps of invalid shapes do not hit anything.
+	*/
+	void SweepTest(std::vector<SweepQuery> const& queries, std::vector<QueryHit>& hits)
+	{
+		auto shapes = GetQueryShapes(queries);
+		hits.assign(queries.size(), {});
+		JobSystem::Instance().ParallelFor(queries.size(), QueryBatchSize, [this, &queries, &shapes, &hits](size_t start, size_t end)
+										  {
+											  for (size_t i = start; i < end; i++)
+											  {
+												  if (shapes[i])
+													  hits[i] = CastSweep(queries[i], (btConvexShape const*)shapes[i].get());
+											  }
+										  });
+	}
+
+	/**
+	 * @brief Find the overlaps of a batch of convex shapes in parallel.
+	 * @note Has to be called between the steps, as it reads the world while the job system runs the tests.
+	 * @param queries
+	 * @param overlaps Entities touched by every shape, in the same order.
+	*/
+	void OverlapTest(std::vector<OverlapQuery> const& queries, std::vector<std::vector<int>>& overlaps)
+	{
+		auto shapes = GetQueryShapes(queries);
+		overlaps.assign(queries.size(), {});
+		JobSystem::Instance().ParallelFor(queries.size(), QueryBatchSize, [this, &queries, &shapes, &overlaps](size_t start, size_t end)
+										  {
+											  for (size_t i = start; i < end; i++)
+											  {
+												  if (shapes[i])
+													  overlaps[i] = FindOverlaps(queries[i], (btConvexShape const*)shapes[i].get());
+											  }
+										  });
+	}
+
+	/**
+	 * @brief Run the queries that the scripts have added during the step and key the results by their entities.
+	 * @param queries
+	*/
+	void RunQueries(PhysicsQueries& queries)
+	{
+		std::vector<QueryHit> hits;
+		RayTest(queries.mRays, hits);
+		queries.mRayHits.clear();
+		for (size_t i = 0; i < hits.size(); i++)
+			queries.mRayHits[queries.mRays[i].mEntity] = hits[i];
+
+		SweepTest(queries.mSweeps, hits);
+		queries.mSweepHits.clear();
+		for (size_t i = 0; i < hits.size(); i++)
+			queries.mSweepHits[queries.mSweeps[i].mEntity] = hits[i];
+
+		std::vector<std::vector<int>> overlaps;
+		OverlapTest(queries.mOverlaps, overlaps);
+		queries.mOverlapHits.clear();
+		for (size_t i = 0; i < overlaps.size(); i++)
+			queries.mOverlapHits[queries.mOverlaps[i].mEntity] = std::move(overlaps[i]);
+
+		queries.mRays.clear();
+		queries.mSweeps.clear();
+		queries.mOverlaps.clear();
+	}
+};
+
+#endif // GAME
\ No newline at end of file
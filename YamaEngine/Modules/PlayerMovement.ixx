@@ -15,20 +15,47 @@ private:
 	 * @brief A flag to stop player from flying into the sky.
 	*/
 	bool mOnGround = false;
+
+	/**
+	 * @brief Length of the ground ray from the center of the collider, a bit longer than the half height of the player's box.
+	*/
+	static constexpr float GroundRayLength = 1.2f;
+
+	/**
+	 * @brief Check the result of the last ground ray and cast the next one.
+	*/
+	inline void UpdateGrounding(entt::registry& registry, entt::entity const& thisEntity, PhysicalBody const& physicalBody)
+	{
+		auto* queries = registry.try_ctx<PhysicsQueries>();
+		if (!queries)
+			return;
+
+		// The result is from the previous step, which is close enough for jumping.
+		auto* groundHit = queries->GetRayHit((int)thisEntity);
+		mOnGround = false;
+		// The hit entity might have been deleted since then.
+		if (groundHit && groundHit->HasHit() && registry.valid((entt::entity)groundHit->mEntity))
+		{
+			auto* otherIdentity = registry.try_get<Identity>((entt::entity)groundHit->mEntity);
+			mOnGround = otherIdentity && otherIdentity->mTag == "Floor";
+		}
+
+		auto center = yamath::opr::Add(physicalBody.GetPosition(), physicalBody.mOffset);
+		queries->CastRay({ (int)thisEntity, center, yamath::opr::Sub(center, { 0, GroundRayLength, 0 }) });
+	}
 public:
-	[[nodiscard]] inline YmEventReturn Start(float deltaTime, entt::registry& registry, entt::entity const& thisEntity) override
+	inline void Start(float deltaTime, entt::registry& registry, entt::entity const& thisEntity, EventWriter& events) override
 	{
 		auto* physicalBody = registry.try_get<PhysicalBody>(thisEntity);
 
 		if (!physicalBody)
-			return {};
+			return;
 
 		physicalBody->DisableSleep();
 
-		return {};
 	}
 
-	[[nodiscard]] inline YmEventReturn Update(float deltaTime, entt::registry& registry, entt::entity const& thisEntity) override
+	inline void Update(float deltaTime, entt::registry& registry, entt::entity const& thisEntity, EventWriter& events) override
 	{
 		auto* camera = registry.try_get<CameraComponent>(thisEntity);
 
@@ -40,7 +67,8 @@ public:
 
 			auto* physicalBody = registry.try_get<PhysicalBody>(thisEntity);
 			if (!physicalBody)
-				return {};
+				return;
+			UpdateGrounding(registry, thisEntity, *physicalBody);
 			auto speed = deltaTime * 30;
 
 			auto [X, Y, Z] = physicalBody->GetVelocity();
@@ -77,27 +105,6 @@ public:
 			}
 		}
 
-		return {};
-	}
-
-	[[nodiscard]] inline YmEventReturn OnCollisionEnter(float deltaTimem, entt::registry& registry, entt::entity const& thisEntity, entt::entity const& thatEntity) override
-	{
-		auto* otherTransform = registry.try_get<Transform>(thatEntity);
-
-		if (otherTransform && otherTransform->mTag == "Floor")
-			mOnGround = true;
-
-		return {};
-
-	}
-
-	[[nodiscard]] inline YmEventReturn OnCollisionExit(float deltaTimem, entt::registry& registry, entt::entity const& thisEntity, entt::entity const& thatEntity) override
-	{
-		auto* otherTransform = registry.try_get<Transform>(thatEntity);
-
-		if (otherTransform && otherTransform->mTag == "Floor")
-			mOnGround = false;
-		return {};
 	}
 };
 #endif // GAME
\ No newline at end of file
@@ -66,12 +66,12 @@ private:
 	}
 public:
 
-	[[nodiscard]] inline YmEventReturn Start(float deltaTime, entt::registry& registry, entt::entity const& thisEntity) override
+	inline void Start(float deltaTime, entt::registry& registry, entt::entity const& thisEntity, EventWriter& events) override
 	{
 		// Set the cap.
-		for (auto&& [entity, transform] : registry.view<Transform>().each())
+		for (auto&& [entity, identity] : registry.view<Identity>().each())
 		{
-			if (transform.mTag == "Main point")
+			if (identity.mTag == "Main point")
 				mMaxMainScore++;
 		}
 
@@ -89,35 +89,28 @@ public:
 			mPreviousScore = std::any_cast<int>(scoreFromPreviousScene);
 		}
 
-		YmEventList events;
-		events.emplace_back(YmEventTypes::CursorState, new int(CursorStates::CursorInvisible));
-		return events;
+		events.Emit(CursorStateEvent{ CursorStates::CursorInvisible });
 	}
 
-	[[nodiscard]] inline YmEventReturn Update(float deltaTime, entt::registry& registry, entt::entity const& thisEntity) override
+	inline void Update(float deltaTime, entt::registry& registry, entt::entity const& thisEntity, EventWriter& events) override
 	{
 		if (mCollectedMainScore == mMaxMainScore)
 		{
 
 
 			DataVault["FinalSceore"] = TotalScoreCalculation();
-			YmEventList sceneChange;
-			sceneChange.emplace_back(YmEventTypes::ChangeScene, new SceneChangeMessage{ std::make_pair(-1, true) });
-
-			return sceneChange;
+			events.Emit(ChangeSceneEvent{ std::make_pair(-1, true) });
 		}
-		return {};
 	}
 
-	[[nodiscard]] inline YmEventReturn OnCollisionEnter(float deltaTimem, entt::registry& registry, entt::entity const& thisEntity, entt::entity const& thatEntity) override
+	inline void OnCollisionEnter(float deltaTimem, entt::registry& registry, entt::entity const& thisEntity, entt::entity const& thatEntity, EventWriter& events) override
 	{
-		auto* otherTransform = registry.try_get<Transform>(thatEntity);
+		auto* otherIdentity = registry.try_get<Identity>(thatEntity);
 
-		auto otherTag = otherTransform->mTag;
-		YmEventList events;
+		if (!otherIdentity)
+			return;
 
-		if (!otherTransform)
-			return {};
+		auto& otherTag = otherIdentity->mTag;
 
 		if (otherTag == "Main point")
 		{
@@ -131,33 +124,27 @@ public:
 				source.PlaySource();
 			}
 
-			events.emplace_back(YmEventTypes::DeleteEntity, new int((int)thatEntity));
+			events.Emit(DeleteEntityEvent{ thatEntity });
 		}
 
 		else if (otherTag == "Extra point")
 		{
 			mCollectedExtraScore++;
-			events.emplace_back(YmEventTypes::DeleteEntity, new int((int)thatEntity));
+			events.Emit(DeleteEntityEvent{ thatEntity });
 		}
 
 		else if (otherTag == "Death")
 		{
 			DataVault["FinalSceore"] = TotalScoreCalculation();
-			events.emplace_back(YmEventTypes::ChangeScene, new SceneChangeMessage{-1});
+			events.Emit(ChangeSceneEvent{ -1 });
 		}
-
-		if (events.size() > 0)
-			return events;
-
-		return {};
 	}
 
-	[[nodiscard]] inline virtual YmEventReturn DrawItems() override
+	inline virtual void DrawItems(EventWriter& events) override
 	{
 		auto timeSpanSeconds = ElapsedTimeInSeconds();
 
 		GUI::Instance().PlayerCurrentScore(timeSpanSeconds, mCollectedMainScore, mCollectedExtraScore, mMaxMainScore);
-		return {};
 	}
 };
 #endif // GAME
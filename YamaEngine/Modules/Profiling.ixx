@@ -1,15 +1,24 @@
 #ifdef PROFILING
 // CPU And memory retrieval is based on
 // https://stackoverflow.com/questions/63166/how-to-determine-cpu-and-memory-consumption-from-inside-a-process [2021/11/28]
+// Linux part reads the /proc files, see https://man7.org/linux/man-pages/man5/proc.5.html
 module;
+#ifdef _WIN32
 #include <Windows.h>;
 #include "psapi.h"
+#else
+#include <unistd.h>
+#endif // _WIN32
 
 export module YaMaProfiling;
 import <chrono>;
+import <fstream>;
+import <string>;
+import <sstream>;
 
 namespace yaprfl
 {
+#ifdef _WIN32
 	// Memory
 
 	PROCESS_MEMORY_COUNTERS_EX pmc;
@@ -76,6 +85,82 @@ namespace yaprfl
 
 		return percent * 100;
 	}
+#else
+	// CPU
+
+	static std::chrono::steady_clock::time_point lastCPU;
+	static double lastProcessCPU;
+	static long numProcessors;
+
+	/**
+	 * @brief Get the CPU time used by the process in seconds, from the utime and stime fields of /proc/self/stat.
+	*/
+	double ReadProcessCPUTime()
+	{
+		std::ifstream statFile("/proc/self/stat");
+		std::string stat;
+		std::getline(statFile, stat);
+
+		// The process name can contain spaces, so the fields are counted from the end of it. First field after it is the 3rd one.
+		auto nameEnd = stat.rfind(')');
+		if (nameEnd == std::string::npos)
+			return 0;
+
+		std::istringstream fields(stat.substr(nameEnd + 2));
+		std::string field;
+		unsigned long long utime = 0, stime = 0;
+		for (int i = 3; i <= 15 && fields >> field; i++)
+		{
+			if (i == 14)
+				utime = std::stoull(field);
+			else if (i == 15)
+				stime = std::stoull(field);
+		}
+
+		return double(utime + stime) / sysconf(_SC_CLK_TCK);
+	}
+
+	/**
+	 * @brief Initialize the data needed for profiling.
+	*/
+	export void Init()
+	{
+		numProcessors = sysconf(_SC_NPROCESSORS_ONLN);
+		lastCPU = std::chrono::steady_clock::now();
+		lastProcessCPU = ReadProcessCPUTime();
+	}
+
+	/**
+	 * @brief Get used RAM by the process.
+	*/
+	export size_t GetUsedMemory()
+	{
+		// Second field of statm is the resident set size in pages.
+		std::ifstream statmFile("/proc/self/statm");
+		size_t totalPages = 0, residentPages = 0;
+		statmFile >> totalPages >> residentPages;
+		return residentPages * sysconf(_SC_PAGESIZE);
+	}
+
+	/**
+	 * @brief Get the process usage of CPU in %.
+	*/
+	export double GetCPUUsage()
+	{
+		auto now = std::chrono::steady_clock::now();
+		auto processCPU = ReadProcessCPUTime();
+		std::chrono::duration<double> wallTime = now - lastCPU;
+
+		double percent = 0;
+		if (wallTime.count() > 0 && numProcessors > 0)
+			percent = (processCPU - lastProcessCPU) / wallTime.count() / numProcessors;
+
+		lastCPU = now;
+		lastProcessCPU = processCPU;
+
+		return percent * 100;
+	}
+#endif // _WIN32
 
 	/**
 	 * @brief Helper class for calculating passed time.
@@ -0,0 +1,371 @@
+export module ProfilingZones;
+import <chrono>;
+import <vector>;
+import <string>;
+import <string_view>;
+import <mutex>;
+import <memory>;
+import <atomic>;
+import <unordered_set>;
+import <fstream>;
+import <utility>;
+import <initializer_list>;
+import Logger;
+
+// Unlike the rest of the profiling, this module is always there, so that the zones can be put into any module or script without guarding them.
+// Without PROFILING the zones are empty and get optimized away.
+// Every thread writes into its own buffer, so recording a zone never waits for a lock. The lock is only taken once per thread, when its buffer is created.
+
+namespace yaprfl
+{
+#ifdef PROFILING
+	/**
+	 * @brief A finished zone.
+	*/
+	struct ZoneEvent
+	{
+		/**
+		 * @brief Name of the zone, has to outlive the capture.
+		*/
+		char const* mName;
+
+		/**
+		 * @brief Start of the zone in nanoseconds since the profiler start.
+		*/
+		long long mStart;
+
+		/**
+		 * @brief Duration of the zone in nanoseconds.
+		*/
+		long long mDuration;
+
+		/**
+		 * @brief How many zones this one is nested in.
+		*/
+		unsigned int mDepth;
+	};
+
+	/**
+	 * @brief Values of a counter at a point in time, shown as a graph in the trace.
+	*/
+	struct CounterEvent
+	{
+		/**
+		 * @brief Name of the counter, has to outlive the capture.
+		*/
+		char const* mName;
+
+		/**
+		 * @brief Time of the values in nanoseconds since the profiler start.
+		*/
+		long long mTime;
+
+		/**
+		 * @brief Series names, which have to outlive the capture, and their values.
+		*/
+		std::vector<std::pair<char const*, long long>> mValues;
+	};
+
+	/**
+	 * @brief Zones recorded by a single thread.
+	*/
+	struct ThreadBuffer
+	{
+		/**
+		 * @brief Name shown in the trace.
+		*/
+		std::string mThreadName;
+
+		/**
+		 * @brief ID shown in the trace.
+		*/
+		unsigned int mThreadId = 0;
+
+		/**
+		 * @brief Finished zones.
+		*/
+		std::vector<ZoneEvent> mEvents;
+
+		/**
+		 * @brief Recorded counter values.
+		*/
+		std::vector<CounterEvent> mCounters;
+
+		/**
+		 * @brief Amount of currently open zones.
+		*/
+		unsigned int mDepth = 0;
+	};
+
+	/**
+	 * @brief Limit of the recorded zones per thread, so that a forgotten capture does not eat all of the memory.
+	*/
+	constexpr size_t MaxEventsPerThread = 1 << 20;
+
+	/**
+	 * @brief Buffers of every thread that has recorded a zone.
+	*/
+	std::vector<std::unique_ptr<ThreadBuffer>> threadBuffers;
+
+	/**
+	 * @brief Guard for the buffer collection.
+	*/
+	std::mutex buffersMutex;
+
+	/**
+	 * @brief Buffer of the current thread.
+	*/
+	thread_local ThreadBuffer* tBuffer = nullptr;
+
+	/**
+	 * @brief Zone names that were created at runtime.
+	*/
+	std::unordered_set<std::string> internedNames;
+
+	/**
+	 * @brief Guard for the interned names.
+	*/
+	std::mutex namesMutex;
+
+	/**
+	 * @brief Flag for recording the zones.
+	*/
+	std::atomic<bool> capturing = false;
+
+	/**
+	 * @brief Point from which the zone times are measured.
+	*/
+	auto const profilerStart = std::chrono::steady_clock::now();
+
+	/**
+	 * @brief Get the nanoseconds passed since the profiler start.
+	*/
+	inline long long Now()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - profilerStart).count();
+	}
+
+	/**
+	 * @brief Get the buffer of the current thread, creating it if needed.
+	*/
+	inline ThreadBuffer& GetThreadBuffer()
+	{
+		if (!tBuffer)
+		{
+			std::lock_guard lock(buffersMutex);
+			auto& buffer = threadBuffers.emplace_back(std::make_unique<ThreadBuffer>());
+			buffer->mThreadId = (unsigned int)threadBuffers.size() - 1;
+			buffer->mThreadName = std::format("Thread {}", buffer->mThreadId);
+			tBuffer = buffer.get();
+		}
+		return *tBuffer;
+	}
+
+	/**
+	 * @brief Escape the text so it can be put into a JSON string.
+	*/
+	inline std::string EscapeJson(std::string_view const& text)
+	{
+		std::string escaped;
+		escaped.reserve(text.size());
+		for (auto const& character : text)
+		{
+			if (character == '"' || character == '\\')
+				escaped += '\\';
+			escaped += character;
+		}
+		return escaped;
+	}
+#endif // PROFILING
+
+	/**
+	 * @brief Store a zone name that is not a string literal, so that it lives as long as the profiler.
+	 * @param name
+	 * @return Pointer that can be passed to the zones.
+	*/
+	export inline char const* InternName(std::string const& name)
+	{
+#ifdef PROFILING
+		std::lock_guard lock(namesMutex);
+		return internedNames.emplace(name).first->c_str();
+#else
+		return "";
+#endif // PROFILING
+	}
+
+	/**
+	 * @brief Set the name of the current thread that will be shown in the trace.
+	 * @param name
+	*/
+	export inline void SetThreadName(std::string const& name)
+	{
+#ifdef PROFILING
+		GetThreadBuffer().mThreadName = name;
+#endif // PROFILING
+	}
+
+	/**
+	 * @brief Start recording the zones.
+	*/
+	export inline void StartCapture()
+	{
+#ifdef PROFILING
+		capturing = true;
+#else
+		Log(LGR_WARNING, "Zones can only be captured when the engine is built with profiling");
+#endif // PROFILING
+	}
+
+	/**
+	 * @brief Stop recording the zones. The recorded ones are kept.
+	*/
+	export inline void StopCapture()
+	{
+#ifdef PROFILING
+		capturing = false;
+#endif // PROFILING
+	}
+
+	/**
+	 * @brief Remove all of the recorded zones.
+	 * @note Should not be called while other threads are recording.
+	*/
+	export inline void ClearCapture()
+	{
+#ifdef PROFILING
+		std::lock_guard lock(buffersMutex);
+		for (auto& buffer : threadBuffers)
+		{
+			buffer->mEvents.clear();
+			buffer->mCounters.clear();
+		}
+#endif // PROFILING
+	}
+
+	/**
+	 * @brief Measures the time from its creation until it goes out of scope.
+	 * @note Zones can be nested, e.g. a physics zone inside of a frame zone.
+	*/
+	export class ScopedZone
+	{
+#ifdef PROFILING
+	private:
+		/**
+		 * @brief Name of the zone. Has to be a string literal or interned.
+		*/
+		char const* mName;
+
+		/**
+		 * @brief Start time, negative if the zone is not recorded.
+		*/
+		long long mStart = -1;
+#endif // PROFILING
+	public:
+		explicit ScopedZone(char const* name)
+#ifdef PROFILING
+			: mName(name)
+		{
+			if (!capturing)
+				return;
+
+			GetThreadBuffer().mDepth++;
+			mStart = Now();
+		}
+#else
+		{
+		}
+#endif // PROFILING
+
+		ScopedZone(ScopedZone const&) = delete;
+		ScopedZone& operator=(ScopedZone const&) = delete;
+
+		~ScopedZone()
+		{
+#ifdef PROFILING
+			if (mStart < 0)
+				return;
+
+			auto end = Now();
+			auto& buffer = *tBuffer;
+			buffer.mDepth--;
+
+			if (buffer.mEvents.size() < MaxEventsPerThread)
+				buffer.mEvents.emplace_back(ZoneEvent{ mName, mStart, end - mStart, buffer.mDepth });
+#endif // PROFILING
+		}
+	};
+
+	/**
+	 * @brief Record the current values of a counter, e.g. the amount of bodies in the physics step.
+	 * @param name Name of the counter. Has to be a string literal or interned.
+	 * @param values Series of the counter and their values. The names have to be string literals or interned.
+	*/
+	export inline void RecordCounters(char const* name, std::initializer_list<std::pair<char const*, long long>> values)
+	{
+#ifdef PROFILING
+		if (!capturing)
+			return;
+
+		auto& buffer = GetThreadBuffer();
+		if (buffer.mCounters.size() < MaxEventsPerThread)
+			buffer.mCounters.emplace_back(CounterEvent{ name, Now(), values });
+#endif // PROFILING
+	}
+
+	/**
+	 * @brief Save the recorded zones in the Chrome trace event format, which can be opened by chrome://tracing or Perfetto.
+	 * @note Should not be called while other threads are recording.
+	 * @param path
+	 * @return False if there was nothing to save or the file could not be written.
+	*/
+	export inline bool ExportChromeTrace(std::string const& path)
+	{
+#ifdef PROFILING
+		std::ofstream file(path);
+		if (file.fail())
+		{
+			Log(LGR_ERROR, std::format("Could not save the trace to \"{}\"", path));
+			return false;
+		}
+
+		std::lock_guard lock(buffersMutex);
+		size_t eventCount = 0;
+		bool first = true;
+		file << "{\"traceEvents\":[\n";
+
+		for (auto const& buffer : threadBuffers)
+		{
+			file << (first ? "" : ",\n") << std::format(R"({{"name":"thread_name","ph":"M","pid":0,"tid":{},"args":{{"name":"{}"}}}})", buffer->mThreadId, EscapeJson(buffer->mThreadName));
+			first = false;
+
+			// Trace times are in microseconds.
+			for (auto const& event : buffer->mEvents)
+			{
+				file << std::format(",\n{{\"name\":\"{}\",\"cat\":\"yama\",\"ph\":\"X\",\"pid\":0,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f},\"args\":{{\"depth\":{}}}}}",
+									EscapeJson(event.mName), buffer->mThreadId, event.mStart / 1000.0, event.mDuration / 1000.0, event.mDepth);
+			}
+			eventCount += buffer->mEvents.size();
+
+			for (auto const& counter : buffer->mCounters)
+			{
+				std::string args;
+				for (auto const& [series, value] : counter.mValues)
+					args += std::format("{}\"{}\":{}", args.empty() ? "" : ",", EscapeJson(series), value);
+
+				file << std::format(",\n{{\"name\":\"{}\",\"cat\":\"yama\",\"ph\":\"C\",\"pid\":0,\"tid\":{},\"ts\":{:.3f},\"args\":{{{}}}}}",
+									EscapeJson(counter.mName), buffer->mThreadId, counter.mTime / 1000.0, args);
+			}
+			eventCount += buffer->mCounters.size();
+		}
+
+		file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+		file.close();
+
+		Log(LGR_INFO, std::format("Saved {} profiling zones to \"{}\"", eventCount, path));
+		return eventCount > 0;
+#else
+		Log(LGR_WARNING, std::format("Trace \"{}\" was not saved, as the engine was built without profiling", path));
+		return false;
+#endif // PROFILING
+	}
+}
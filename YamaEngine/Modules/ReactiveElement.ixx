@@ -28,17 +28,16 @@ private:
 	*/
 	float mCurrentTime = 0.f;
 public:
-	[[nodiscard]] inline YmEventReturn Update(float deltaTime, entt::registry& registry, entt::entity const& thisEntity) override
+	inline void Update(float deltaTime, entt::registry& registry, entt::entity const& thisEntity, EventWriter& events) override
 	{
 		mCurrentTime += deltaTime;
-		return {};
 	}
 
-	[[nodiscard]] inline YmEventReturn OnCollisionEnter(float deltaTime, entt::registry& registry, entt::entity const& thisEntity, entt::entity const& thatEntity) override
+	inline void OnCollisionEnter(float deltaTime, entt::registry& registry, entt::entity const& thisEntity, entt::entity const& thatEntity, EventWriter& events) override
 	{
-		auto* otherTransform = registry.try_get<Transform>(thatEntity);
+		auto* otherIdentity = registry.try_get<Identity>(thatEntity);
 
-		if (otherTransform && otherTransform->mTag == "Player")
+		if (otherIdentity && otherIdentity->mTag == "Player")
 		{
 			if (mCurrentTime >= mTimeToChange)
 			{
@@ -66,8 +65,6 @@ public:
 				}
 			}
 		}
-
-		return {};
 	}
 };
 #endif // GAME
\ No newline at end of file
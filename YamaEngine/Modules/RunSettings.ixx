@@ -0,0 +1,234 @@
+export module RunSettings;
+import <string>;
+import <string_view>;
+import Logger;
+
+// Kept separate from the Initializer as the command line has to be able to override what is set in the configuration file, and the graphics wrapper needs to know the driver without importing the Initializer.
+
+/**
+ * @brief Graphics driver used when running without a window.
+*/
+export enum class HeadlessDriver
+{
+	None,
+	Null,
+	Software
+};
+
+/**
+ * @brief Allowed slowdown of the benchmark compared to the baseline.
+ * @note Relative values, 0.1 means 10% slower is still fine. 0 turns the check off.
+*/
+export struct RegressionThresholds
+{
+	/**
+	 * @brief Allowed increase of the mean phase time.
+	*/
+	float mMean = 0.1f;
+
+	/**
+	 * @brief Allowed increase of the 99th percentile phase time.
+	*/
+	float mP99 = 0.25f;
+
+	/**
+	 * @brief Allowed increase of the longest phase time.
+	*/
+	float mMax = 0;
+
+	/**
+	 * @brief Differences smaller than this (in milliseconds) are treated as noise.
+	*/
+	float mMinimumDifference = 0.05f;
+};
+
+/**
+ * @brief Settings for how the engine should be run.
+ * @note Populated from the main configuration file and then overridden by the command line arguments.
+*/
+export struct RunSettings
+{
+	/**
+	 * @brief Flag to run the game loop without a window, GUI or audio device.
+	*/
+	bool mHeadless = false;
+
+	/**
+	 * @brief Driver used for the headless run.
+	 * @note Null driver skips the rendering entirely, while the software driver still rasterizes the scene, but does not present it.
+	*/
+	HeadlessDriver mDriver = HeadlessDriver::Null;
+
+	/**
+	 * @brief Frame limit of the headless runs that have no other way to end.
+	*/
+	static constexpr unsigned int DefaultFrameLimit = 1000;
+
+	/**
+	 * @brief Number of frames after which the headless run stops. 0 means no limit.
+	*/
+	unsigned int mFrameLimit = 0;
+
+	/**
+	 * @brief Number of real time seconds after which the headless run stops. 0 means no limit.
+	*/
+	float mSecondsLimit = 0;
+
+	/**
+	 * @brief ID of the scene that is loaded first.
+	*/
+	int mStartScene = 1;
+
+	/**
+	 * @brief Path where the input of the session will be recorded to. Empty means no recording.
+	*/
+	std::string mRecordPath;
+
+	/**
+	 * @brief Path of the recording that will drive the session. Empty means no replay.
+	 * @note Replays are always run headless.
+	*/
+	std::string mReplayPath;
+
+	/**
+	 * @brief Path where the profiling zones of the whole session will be saved as a Chrome trace. Empty means no capture.
+	 * @note Only works when the engine is built with profiling.
+	*/
+	std::string mTracePath;
+
+	/**
+	 * @brief Path where the benchmark results will be saved. Empty means no benchmark.
+	 * @note Benchmarks are always run headless.
+	*/
+	std::string mBenchmarkPath;
+
+	/**
+	 * @brief Path of the earlier benchmark results to compare against. Empty means no comparison.
+	*/
+	std::string mBaselinePath;
+
+	/**
+	 * @brief Amount of frames at the start that are not included in the benchmark, as they contain the loading spikes.
+	*/
+	unsigned int mWarmupFrames = 0;
+
+	/**
+	 * @brief Allowed slowdown compared to the baseline.
+	*/
+	RegressionThresholds mThresholds;
+
+	/**
+	 * @brief Flag to bake the triangle mesh colliders of every scene and exit.
+	*/
+	bool mBakeColliders = false;
+
+	/**
+	 * @brief Get the driver that the graphics wrapper should use.
+	 * @return None if the engine is running with a window.
+	*/
+	inline HeadlessDriver GetDriver() const noexcept
+	{
+		return mHeadless ? mDriver : HeadlessDriver::None;
+	}
+};
+
+/**
+ * @brief Convert the driver name into the driver type.
+ * @param name Either "Null" or "Software".
+ * @return Null driver if the name was not recognized.
+*/
+export inline HeadlessDriver DriverNameToType(std::string_view const& name)
+{
+	if (name == "Software" || name == "software")
+		return HeadlessDriver::Software;
+
+	if (name != "Null" && name != "null")
+		Log(LGR_WARNING, std::format("Could not recognize headless driver \"{}\", Null driver will be used", name));
+
+	return HeadlessDriver::Null;
+}
+
+/**
+ * @brief Override the run settings with the arguments passed to the program.
+ * @note Recognized arguments: --headless, --driver=Null|Software, --frames=N, --seconds=S, --scene=ID, --record=PATH, --replay=PATH, --trace=PATH, --benchmark=PATH, --baseline=PATH, --warmup=N, --bake-colliders.
+ * A headless run without a frame limit, seconds limit or replay gets the default frame limit.
+ * @param settings Settings loaded from the configuration file.
+ * @param argc Passed in argument from the main()
+ * @param argv Passed in argument from the main()
+*/
+export inline void ApplyCommandLine(RunSettings& settings, int argc, char* argv[])
+{
+	for (int i = 1; i < argc; i++)
+	{
+		std::string_view argument = argv[i];
+		auto separator = argument.find('=');
+		auto key = argument.substr(0, separator);
+		auto value = separator == std::string_view::npos ? std::string_view() : argument.substr(separator + 1);
+
+		try
+		{
+			if (key == "--headless")
+			{
+				settings.mHeadless = true;
+			}
+			else if (key == "--driver")
+			{
+				settings.mDriver = DriverNameToType(value);
+			}
+			else if (key == "--frames")
+			{
+				settings.mFrameLimit = std::stoul(std::string(value));
+			}
+			else if (key == "--seconds")
+			{
+				settings.mSecondsLimit = std::stof(std::string(value));
+			}
+			else if (key == "--scene")
+			{
+				settings.mStartScene = std::stoi(std::string(value));
+			}
+			else if (key == "--record")
+			{
+				settings.mRecordPath = value;
+			}
+			else if (key == "--replay")
+			{
+				settings.mReplayPath = value;
+				settings.mHeadless = true;
+			}
+			else if (key == "--trace")
+			{
+				settings.mTracePath = value;
+			}
+			else if (key == "--benchmark")
+			{
+				settings.mBenchmarkPath = value;
+				settings.mHeadless = true;
+			}
+			else if (key == "--baseline")
+			{
+				settings.mBaselinePath = value;
+			}
+			else if (key == "--warmup")
+			{
+				settings.mWarmupFrames = std::stoul(std::string(value));
+			}
+			else if (key == "--bake-colliders")
+			{
+				settings.mBakeColliders = true;
+				settings.mHeadless = true;
+			}
+		}
+		catch (std::exception const& e)
+		{
+			Log(LGR_ERROR, std::format("Could not parse the command line argument \"{}\": {}", argument, e.what()));
+		}
+	}
+
+	// There is no window to close, so the run would never end and the benchmark would never be saved.
+	if (settings.mHeadless && settings.mFrameLimit == 0 && settings.mSecondsLimit == 0 && settings.mReplayPath.empty())
+	{
+		settings.mFrameLimit = RunSettings::DefaultFrameLimit;
+		Log(LGR_WARNING, std::format("Headless run has no frame or seconds limit, it will stop after {} frames", settings.mFrameLimit));
+	}
+}
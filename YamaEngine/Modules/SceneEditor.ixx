@@ -29,7 +29,7 @@ private:
 	char const* pathToConfig;
 public:
 
-	[[nodiscard]] inline virtual YmEventReturn Start(float deltaTime, entt::registry& registry, entt::entity const& thisEntity)
+	inline virtual void Start(float deltaTime, entt::registry& registry, entt::entity const& thisEntity, EventWriter& events)
 	{
 		auto registyRaw = DataVault["GameSceneRegistry"];
 		auto configPathRaw = DataVault["PathToConfig"];
@@ -41,26 +41,19 @@ public:
 
 		mRegistry = std::any_cast<entt::registry*>(registyRaw);
 		pathToConfig = std::any_cast<char const*>(configPathRaw);
-		return {};
 	}
 
-	[[nodiscard]] inline YmEventReturn DrawItems() override
+	inline void DrawItems(EventWriter& events) override
 	{
 		// The idea to have an editor as a part of game scripts came very late (day before submission) so there wasn't any big plan how to make it fit. That's why the received registry argument is re-purposed to have the scene item registry.
-		YmEventList gameEvents;
-
 		GUI::Instance().DrawMenuBar();
-		{
-			auto events = GUI::Instance().DrawEntityManager(*mRegistry);
-			if (events.has_value())
-				MergeYmEventLists(gameEvents, events.value());
-		}
+		GUI::Instance().DrawEntityManager(*mRegistry, events);
 
 		// Update the transform and the mesh component (if there is one).
-		for (auto&& [entity, editTransform, transform] : mRegistry->view<TransformEditorComponent, Transform>().each())
+		for (auto&& [entity, editTransform, transform, identity] : mRegistry->view<TransformEditorComponent, Transform, Identity>().each())
 		{
 			auto* editMeshComp = mRegistry->try_get<GraphicsEditorComponent>(entity);
-			mGameEditor.PopulateTransform(transform, editTransform);
+			mGameEditor.PopulateTransform(transform, identity, editTransform);
 
 			if (editMeshComp)
 			{
@@ -88,16 +81,12 @@ public:
 			if (scenePath.has_value())
 			{
 				auto path = scenePath.value();
-				gameEvents.emplace_back(YmEventTypes::SceneFileLoad, new std::string(path));
+				events.Emit(SceneFileLoadEvent{ path });
 			}
 		}
 
 		// Checks if player has chosen to delete the scene. The deletion has to be in the menu wrapper as it becomes complicated to track the state of it and reset menu related data.
 		GUI::Instance().CheckAndCleaneScene(*mRegistry);
-
-		if (gameEvents.size() > 0)
-			return gameEvents;
-		return {};
 	};
 };
 #endif // DEBUG
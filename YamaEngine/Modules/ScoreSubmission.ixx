@@ -25,9 +25,8 @@ private:
 	std::string name;
 public:
 
-	[[nodiscard]] inline YmEventReturn Start(float deltaTime, entt::registry& registry, entt::entity const& thisEntity) override
+	inline void Start(float deltaTime, entt::registry& registry, entt::entity const& thisEntity, EventWriter& events) override
 	{
-		YmEventList events;
 		auto value = DataVault.find("FinalSceore");
 
 		if (value != DataVault.end())
@@ -39,30 +38,21 @@ public:
 		else
 		{
 			Log(LGR_INFO, "Score data was not stored prior to the submission scene call");
-			events.emplace_back(YmEventTypes::ChangeScene, new SceneChangeMessage{ 1 });
+			events.Emit(ChangeSceneEvent{ 1 });
 		}
 
-		events.emplace_back(YmEventTypes::CursorState, new int(0));
-		return events;
+		events.Emit(CursorStateEvent{ 0 });
 	}
 
-	[[nodiscard]] inline YmEventReturn DrawItems() override
+	inline void DrawItems(EventWriter& events) override
 	{
 
 		bool upload = false;
-		auto events =  GUI::Instance().ScoreSubmission(mScore, name, upload);
-		if (events.has_value())
+		if (GUI::Instance().ScoreSubmission(mScore, name, upload, events) && upload)
 		{
-			if (upload)
-			{
-				HighScoreEntity score{ .mScore = mScore, .mName = name };
-				HighscoreWrapper::UploadHighscore(score);
-			}
-
-			return events;
+			HighScoreEntity score{ .mScore = mScore, .mName = name };
+			HighscoreWrapper::UploadHighscore(score);
 		}
-
-		return {};
 	}
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,185 @@
+module;
+#include "entity/registry.hpp"
+export module TaskGraph;
+import <vector>;
+import <deque>;
+import <string>;
+import <functional>;
+import <atomic>;
+import <algorithm>;
+import JobSystem;
+import ProfilingZones;
+
+/**
+ * @brief Get the IDs of the component types, used for declaring what a task reads or writes.
+ * @tparam ...ComponentTypes
+ * @return
+*/
+export template <typename... ComponentTypes>
+inline std::vector<entt::id_type> ComponentIds()
+{
+	return { entt::type_hash<ComponentTypes>::value()... };
+}
+
+/**
+ * @brief A graph of tasks that are run every frame.
+ * @note The dependencies between tasks are derived from the components they declare as read or written, in the order the tasks were added:
+ * a task waits for every earlier task that writes what it reads or writes, or reads what it writes. Tasks without such conflicts run in parallel.
+*/
+export class TaskGraph
+{
+private:
+	/**
+	 * @brief A single node of the graph.
+	*/
+	struct Task
+	{
+		/**
+		 * @brief Name of the task, used for debugging and profiling.
+		*/
+		std::string mName;
+
+		/**
+		 * @brief Name of the task that lives as long as the profiler.
+		*/
+		char const* mZoneName = nullptr;
+
+		/**
+		 * @brief The work itself.
+		*/
+		std::function<void()> mWork;
+
+		/**
+		 * @brief Component types that the task only reads.
+		*/
+		std::vector<entt::id_type> mReads;
+
+		/**
+		 * @brief Component types that the task modifies.
+		*/
+		std::vector<entt::id_type> mWrites;
+
+		/**
+		 * @brief Indexes of tasks that wait for this one.
+		*/
+		std::vector<size_t> mDependents;
+
+		/**
+		 * @brief Amount of tasks that have to be finished before this one can start.
+		*/
+		int mDependencyCount = 0;
+
+		/**
+		 * @brief Amount of unfinished dependencies in the current run.
+		*/
+		std::atomic<int> mRemainingDependencies = 0;
+	};
+
+	// Deque as the tasks contain atomics, which cannot be moved when a vector grows.
+
+	/**
+	 * @brief Tasks in the order they were added.
+	*/
+	std::deque<Task> mTasks;
+private:
+	/**
+	 * @brief Check if two collections of component IDs have anything in common.
+	*/
+	inline static bool Overlaps(std::vector<entt::id_type> const& a, std::vector<entt::id_type> const& b)
+	{
+		return std::any_of(a.begin(), a.end(), [&b](auto const& id) { return std::find(b.begin(), b.end(), id) != b.end(); });
+	}
+
+	/**
+	 * @brief Check if the later task has to wait for the earlier one.
+	*/
+	inline static bool Conflicts(Task const& earlier, Task const& later)
+	{
+		return Overlaps(earlier.mWrites, later.mReads) || Overlaps(earlier.mWrites, later.mWrites) || Overlaps(earlier.mReads, later.mWrites);
+	}
+
+	/**
+	 * @brief Run the task and schedule the dependents that became ready.
+	*/
+	void RunTask(size_t const index, JobSystem& jobSystem, JobCounter& counter)
+	{
+		auto& task = mTasks[index];
+		{
+			yaprfl::ScopedZone zone(task.mZoneName);
+			task.mWork();
+		}
+
+		for (auto const& dependentIndex : task.mDependents)
+		{
+			// The last dependency to finish is responsible for scheduling.
+			if (--mTasks[dependentIndex].mRemainingDependencies == 0)
+				jobSystem.Submit([this, dependentIndex, &jobSystem, &counter]() { RunTask(dependentIndex, jobSystem, counter); }, counter);
+		}
+	}
+public:
+	TaskGraph() = default;
+	TaskGraph(TaskGraph const&) = delete;
+	TaskGraph& operator=(TaskGraph const&) = delete;
+
+	/**
+	 * @brief Add a task to the graph.
+	 * @param name Name of the task.
+	 * @param reads Component types that are only read, use ComponentIds<...>().
+	 * @param writes Component types that are modified, use ComponentIds<...>().
+	 * @param work The function that will be run.
+	*/
+	void AddTask(std::string const& name, std::vector<entt::id_type> reads, std::vector<entt::id_type> writes, std::function<void()> work)
+	{
+		auto& task = mTasks.emplace_back();
+		task.mName = name;
+		task.mZoneName = yaprfl::InternName(name);
+		task.mWork = std::move(work);
+		task.mReads = std::move(reads);
+		task.mWrites = std::move(writes);
+
+		auto const newIndex = mTasks.size() - 1;
+		for (size_t i = 0; i < newIndex; i++)
+		{
+			if (Conflicts(mTasks[i], task))
+			{
+				mTasks[i].mDependents.emplace_back(newIndex);
+				task.mDependencyCount++;
+			}
+		}
+	}
+
+	/**
+	 * @brief Run all of the tasks and wait for them to finish.
+	 * @param jobSystem
+	*/
+	void Execute(JobSystem& jobSystem)
+	{
+		for (auto& task : mTasks)
+			task.mRemainingDependencies = task.mDependencyCount;
+
+		JobCounter counter = 0;
+		for (size_t i = 0; i < mTasks.size(); i++)
+		{
+			if (mTasks[i].mDependencyCount == 0)
+				jobSystem.Submit([this, i, &jobSystem, &counter]() { RunTask(i, jobSystem, counter); }, counter);
+		}
+
+		jobSystem.Wait(counter);
+	}
+
+	/**
+	 * @brief Remove all of the tasks.
+	*/
+	inline void Clear()
+	{
+		mTasks.clear();
+	}
+
+	/**
+	 * @brief Get the amount of tasks in the graph.
+	*/
+	inline size_t GetTaskCount() const noexcept
+	{
+		return mTasks.size();
+	}
+};
@@ -1,11 +1,15 @@
+module;
+#include "entity/registry.hpp"
 export module Component.Transform;
 import <string>;
+import <utility>;
 import YaMath;
 using namespace yamath;
 /**
- * @brief Basic transform component.
+ * @brief Name and tag of the entity.
+ * @note Kept apart from the transform, as it is rarely read, while the transform loops should only touch the spatial data.
 */
-export struct Transform
+export struct Identity
 {
 	/**
 	 * @brief The name of the entity.
@@ -17,7 +21,13 @@ export struct Transform
 	 * @note Used to denote a certain type of object with a more general behavior, e.g. Player, Score, Death.
 	*/
 	std::string mTag;
+};
 
+/**
+ * @brief Basic transform component.
+*/
+export struct Transform
+{
 	/**
 	 * @brief Global position.
 	*/
@@ -25,15 +35,98 @@ export struct Transform
 
 	/**
 	 * @brief Global rotation.
+	 * @note Euler angles are only used in the scene files, the editor and the graphics nodes, see opr::FromEuler and opr::ToEuler.
 	*/
-	Vec3D mRotation;
+	Quat mRotation;
 
 	/**
 	 * @brief Global scale.
 	*/
 	Vec3D mScale;
 
+	// Writes have to go through the registry, as that is what raises the update signal that the engine uses to find the moved entities.
+
+	/**
+	 * @brief Modify the transform of the entity and mark it as moved.
+	 * @note Changes made through a plain reference are not picked up by the physics or the graphics.
+	 * @param registry
+	 * @param entity
+	 * @param function Called with the transform of the entity.
+	*/
+	template<typename Function>
+	inline static void Modify(entt::registry& registry, entt::entity const& entity, Function&& function)
+	{
+		registry.patch<Transform>(entity, std::forward<Function>(function));
+	}
+
+	/**
+	 * @brief Set the position of the entity.
+	*/
+	inline static void SetPosition(entt::registry& registry, entt::entity const& entity, Vec3D const& position)
+	{
+		Modify(registry, entity, [&position](Transform& transform) { transform.mPosition = position; });
+	}
+
+	/**
+	 * @brief Set the rotation of the entity.
+	*/
+	inline static void SetRotation(entt::registry& registry, entt::entity const& entity, Quat const& rotation)
+	{
+		Modify(registry, entity, [&rotation](Transform& transform) { transform.mRotation = rotation; });
+	}
+
+	/**
+	 * @brief Rotate the entity by the rotation, which is applied after the current one.
+	*/
+	inline static void Rotate(entt::registry& registry, entt::entity const& entity, Quat const& rotation)
+	{
+		Modify(registry, entity, [&rotation](Transform& transform) { transform.mRotation = opr::Normalize(opr::Mult(rotation, transform.mRotation)); });
+	}
+
+	/**
+	 * @brief Move the entity by the offset.
+	*/
+	inline static void Translate(entt::registry& registry, entt::entity const& entity, Vec3D const& offset)
+	{
+		Modify(registry, entity, [&offset](Transform& transform) { transform.mPosition = opr::Add(transform.mPosition, offset); });
+	}
+
 	// Use to have implementation of the rule of five, but saw this.
 	//https://stackoverflow.com/questions/4819936/why-no-default-move-assignment-move-constructor
 	// Also removed the getters and setter to make this smaller and lighter.
+};
+
+static_assert(sizeof(Transform) == 10 * sizeof(float), "Transform should only contain the tightly packed spatial data");
+
+/**
+ * @brief Spatial state of the entity before the latest fixed step.
+ * @note Only the drawn entities have it, as it is used to interpolate the graphical nodes between the fixed steps.
+*/
+export struct PreviousTransform
+{
+	/**
+	 * @brief Global position.
+	*/
+	Vec3D mPosition;
+
+	/**
+	 * @brief Global rotation.
+	*/
+	Quat mRotation;
+
+	/**
+	 * @brief Global scale.
+	*/
+	Vec3D mScale;
+
+	/**
+	 * @brief Copy the spatial state of the transform.
+	 * @param transform
+	*/
+	inline void Store(Transform const& transform) noexcept
+	{
+		mPosition = transform.mPosition;
+		mRotation = transform.mRotation;
+		mScale = transform.mScale;
+	}
 };
\ No newline at end of file
@@ -1,3 +1,5 @@
+module;
+#include <xmmintrin.h>
 export module YaMath;
 import <math.h>;
 import <string>;
@@ -19,6 +21,24 @@ namespace yamath
 		float Z;
 	};
 
+	/**
+	 * @brief A unit quaternion for rotations.
+	 * @note Kept unaligned, so that it packs tightly into the components. The SIMD operations use unaligned loads.
+	 * Defaults to the identity, as a zero quaternion is not a rotation.
+	*/
+	export struct Quat
+	{
+		float X = 0;
+		float Y = 0;
+		float Z = 0;
+		float W = 1;
+	};
+
+	/**
+	 * @brief Quaternion without any rotation.
+	*/
+	export constexpr inline Quat IdentityQuat{ .X = 0, .Y = 0, .Z = 0, .W = 1 };
+
 	/**
 	 * @brief A namespace containing mathematical operations.
 	*/
@@ -212,5 +232,253 @@ namespace yamath
 		{
 			return angleInRadians * ToDegreesCoeficient;
 		}
+
+		// Euler angles are only meant for the boundaries (scene files, editor and Irrlicht), the engine itself works with the quaternions.
+		// The order matches Bullet's setEulerZYX and Irrlicht's setRotation, i.e. X is applied first, then Y and then Z.
+
+		/**
+		 * @brief Create a quaternion from Euler angles in degrees.
+		*/
+		export inline Quat FromEuler(Vec3D const& degrees) noexcept
+		{
+			auto halfX = ToRadians(degrees.X) * 0.5f;
+			auto halfY = ToRadians(degrees.Y) * 0.5f;
+			auto halfZ = ToRadians(degrees.Z) * 0.5f;
+
+			auto cosX = cosf(halfX), sinX = sinf(halfX);
+			auto cosY = cosf(halfY), sinY = sinf(halfY);
+			auto cosZ = cosf(halfZ), sinZ = sinf(halfZ);
+
+			return {
+				.X = sinX * cosY * cosZ - cosX * sinY * sinZ,
+				.Y = cosX * sinY * cosZ + sinX * cosY * sinZ,
+				.Z = cosX * cosY * sinZ - sinX * sinY * cosZ,
+				.W = cosX * cosY * cosZ + sinX * sinY * sinZ };
+		}
+
+		/**
+		 * @brief Get the Euler angles in degrees of a quaternion.
+		*/
+		export inline Vec3D ToEuler(Quat const& q) noexcept
+		{
+			auto sinY = -2.f * (q.X * q.Z - q.W * q.Y);
+
+			// At the gimbal lock only the sum of X and Z is known, so X is left at zero.
+			if (sinY <= -0.99999f)
+				return { .X = 0, .Y = -90.f, .Z = ToDegrees(2.f * atan2f(q.X, -q.Y)) };
+
+			if (sinY >= 0.99999f)
+				return { .X = 0, .Y = 90.f, .Z = ToDegrees(2.f * atan2f(-q.X, q.Y)) };
+
+			auto sqX = q.X * q.X;
+			auto sqY = q.Y * q.Y;
+			auto sqZ = q.Z * q.Z;
+			auto sqW = q.W * q.W;
+			return {
+				.X = ToDegrees(atan2f(2.f * (q.Y * q.Z + q.W * q.X), sqW - sqX - sqY + sqZ)),
+				.Y = ToDegrees(asinf(sinY)),
+				.Z = ToDegrees(atan2f(2.f * (q.X * q.Y + q.W * q.Z), sqW + sqX - sqY - sqZ)) };
+		}
+
+		/**
+		 * @brief Combine two rotations, b is applied first and then a.
+		*/
+		export inline Quat Mult(Quat const& a, Quat const& b) noexcept
+		{
+			return {
+				.X = a.W * b.X + a.X * b.W + a.Y * b.Z - a.Z * b.Y,
+				.Y = a.W * b.Y - a.X * b.Z + a.Y * b.W + a.Z * b.X,
+				.Z = a.W * b.Z + a.X * b.Y - a.Y * b.X + a.Z * b.W,
+				.W = a.W * b.W - a.X * b.X - a.Y * b.Y - a.Z * b.Z };
+		}
+
+		/**
+		 * @brief Calculate a dot product between two quaternions.
+		*/
+		export inline float Dot(Quat const& a, Quat const& b) noexcept
+		{
+			return a.X * b.X + a.Y * b.Y + a.Z * b.Z + a.W * b.W;
+		}
+
+		/**
+		 * @brief Normalize a quaternion. A zero quaternion returns the identity.
+		*/
+		export inline Quat Normalize(Quat const& a) noexcept
+		{
+			auto length = sqrt(Dot(a, a));
+			if (length == 0)
+				return IdentityQuat;
+			auto inversedLength = 1 / length;
+			return { .X = a.X * inversedLength, .Y = a.Y * inversedLength, .Z = a.Z * inversedLength, .W = a.W * inversedLength };
+		}
+
+		/**
+		 * @brief Check if two quaternions have the same values.
+		*/
+		export inline bool Equal(Quat const& a, Quat const& b) noexcept
+		{
+			return a.X == b.X && a.Y == b.Y && a.Z == b.Z && a.W == b.W;
+		}
+
+		/**
+		 * @brief Rotate a vector by the quaternion.
+		*/
+		export inline Vec3D Rotate(Quat const& q, Vec3D const& v) noexcept
+		{
+			// v + 2w(u x v) + 2u x (u x v), where u is the vector part of the quaternion.
+			Vec3D u{ .X = q.X, .Y = q.Y, .Z = q.Z };
+			auto t = Mult(Cross(u, v), 2.f);
+			return Add(Add(v, Mult(t, q.W)), Cross(u, t));
+		}
+
+		/**
+		 * @brief Get a string with quaternion XYZW in it. Meant for debugging.
+		*/
+		export inline std::string ToString(Quat const& a) noexcept
+		{
+			return std::format("{} {} {} {}", a.X, a.Y, a.Z, a.W);
+		}
+
+		/**
+		 *@brief Spherical interpolation between two quaternions along the shortest path. From b to a, the same as Lerp.
+
+		 Limits the step between 0 and 1.
+		*/
+		export inline Quat Slerp(Quat const& a, Quat const& b, float step) noexcept
+		{
+			if (step >= 1.f)
+				return a;
+
+			if (step <= 0.f)
+				return b;
+
+			auto cosAngle = Dot(a, b);
+			auto sign = cosAngle < 0 ? -1.f : 1.f;
+			cosAngle *= sign;
+
+			// Close quaternions would divide by a tiny sine, where the linear interpolation is just as good.
+			float fromA = step;
+			float fromB = 1 - step;
+			if (cosAngle < 0.9995f)
+			{
+				auto angle = acosf(cosAngle);
+				auto inversedSin = 1.f / sinf(angle);
+				fromA = sinf(step * angle) * inversedSin;
+				fromB = sinf((1 - step) * angle) * inversedSin;
+			}
+
+			fromA *= sign;
+			return Normalize({
+				.X = a.X * fromA + b.X * fromB,
+				.Y = a.Y * fromA + b.Y * fromB,
+				.Z = a.Z * fromA + b.Z * fromB,
+				.W = a.W * fromA + b.W * fromB });
+		}
+
+		// The batched slerp has no trigonometry, which SSE does not have. Instead the step is corrected with a fitted polynomial before a normalized lerp,
+		// see "Approximating slerp" by Arseny Kapoulkine. The error stays below 0.002 radians, which is not visible in the render interpolation.
+
+		/**
+		 * @brief Corrected step and the shortest path sign of a single quaternion pair.
+		 * @note Meant as an internal function, the scalar reference for the SIMD lanes.
+		*/
+		inline Quat ApproximateSlerp(Quat const& a, Quat const& b, float const step) noexcept
+		{
+			auto cosAngle = Dot(a, b);
+			auto sign = cosAngle < 0 ? -1.f : 1.f;
+			auto d = cosAngle * sign;
+
+			auto k1 = 1.0904f + d * (-3.2452f + d * (3.55645f - d * 1.43519f));
+			auto k2 = 0.848013f + d * (-1.06021f + d * 0.215638f);
+			auto centered = step - 0.5f;
+			auto k = k1 * centered * centered + k2;
+			auto corrected = step + step * centered * (step - 1) * k;
+
+			auto fromA = corrected * sign;
+			auto fromB = 1 - corrected;
+			return Normalize({
+				.X = a.X * fromA + b.X * fromB,
+				.Y = a.Y * fromA + b.Y * fromB,
+				.Z = a.Z * fromA + b.Z * fromB,
+				.W = a.W * fromA + b.W * fromB });
+		}
+
+		/**
+		 * @brief Spherical interpolation of many quaternion pairs with the same step, four at a time. From b to a, the same as Slerp.
+		 * @note Approximated, meant for the render interpolation. The arrays may not overlap with the output.
+		 * @param a Target rotations.
+		 * @param b Starting rotations.
+		 * @param step Limited between 0 and 1.
+		 * @param out Has to have room for count quaternions.
+		 * @param count
+		*/
+		export inline void SlerpBatch(Quat const* a, Quat const* b, float step, Quat* out, size_t const count) noexcept
+		{
+			if (step > 1)
+				step = 1;
+
+			else if (step < 0)
+				step = 0;
+
+			auto centered = step - 0.5f;
+			auto stepCurve = _mm_set1_ps(step * centered * (step - 1));
+			auto centeredSq = _mm_set1_ps(centered * centered);
+			auto stepV = _mm_set1_ps(step);
+			auto one = _mm_set1_ps(1.f);
+			auto signMask = _mm_set1_ps(-0.f);
+
+			size_t i = 0;
+			for (; i + 4 <= count; i += 4)
+			{
+				// Transpose four XYZW quaternions into XXXX, YYYY, ZZZZ, WWWW, so every lane works on its own pair.
+				auto ax = _mm_loadu_ps(&a[i].X);
+				auto ay = _mm_loadu_ps(&a[i + 1].X);
+				auto az = _mm_loadu_ps(&a[i + 2].X);
+				auto aw = _mm_loadu_ps(&a[i + 3].X);
+				_MM_TRANSPOSE4_PS(ax, ay, az, aw);
+
+				auto bx = _mm_loadu_ps(&b[i].X);
+				auto by = _mm_loadu_ps(&b[i + 1].X);
+				auto bz = _mm_loadu_ps(&b[i + 2].X);
+				auto bw = _mm_loadu_ps(&b[i + 3].X);
+				_MM_TRANSPOSE4_PS(bx, by, bz, bw);
+
+				auto cosAngle = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)),
+										   _mm_add_ps(_mm_mul_ps(az, bz), _mm_mul_ps(aw, bw)));
+				auto sign = _mm_and_ps(cosAngle, signMask);
+				auto d = _mm_xor_ps(cosAngle, sign);
+
+				auto k1 = _mm_add_ps(_mm_set1_ps(1.0904f), _mm_mul_ps(d, _mm_add_ps(_mm_set1_ps(-3.2452f),
+								_mm_mul_ps(d, _mm_sub_ps(_mm_set1_ps(3.55645f), _mm_mul_ps(d, _mm_set1_ps(1.43519f)))))));
+				auto k2 = _mm_add_ps(_mm_set1_ps(0.848013f), _mm_mul_ps(d, _mm_add_ps(_mm_set1_ps(-1.06021f), _mm_mul_ps(d, _mm_set1_ps(0.215638f)))));
+				auto k = _mm_add_ps(_mm_mul_ps(k1, centeredSq), k2);
+				auto corrected = _mm_add_ps(stepV, _mm_mul_ps(stepCurve, k));
+
+				auto fromA = _mm_xor_ps(corrected, sign);
+				auto fromB = _mm_sub_ps(one, corrected);
+
+				auto x = _mm_add_ps(_mm_mul_ps(ax, fromA), _mm_mul_ps(bx, fromB));
+				auto y = _mm_add_ps(_mm_mul_ps(ay, fromA), _mm_mul_ps(by, fromB));
+				auto z = _mm_add_ps(_mm_mul_ps(az, fromA), _mm_mul_ps(bz, fromB));
+				auto w = _mm_add_ps(_mm_mul_ps(aw, fromA), _mm_mul_ps(bw, fromB));
+
+				// The interpolated quaternion of two unit ones is never close to zero, so there is no need for the zero check of Normalize.
+				auto lengthSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_add_ps(_mm_mul_ps(z, z), _mm_mul_ps(w, w)));
+				auto inversedLength = _mm_div_ps(one, _mm_sqrt_ps(lengthSq));
+				x = _mm_mul_ps(x, inversedLength);
+				y = _mm_mul_ps(y, inversedLength);
+				z = _mm_mul_ps(z, inversedLength);
+				w = _mm_mul_ps(w, inversedLength);
+
+				_MM_TRANSPOSE4_PS(x, y, z, w);
+				_mm_storeu_ps(&out[i].X, x);
+				_mm_storeu_ps(&out[i + 1].X, y);
+				_mm_storeu_ps(&out[i + 2].X, z);
+				_mm_storeu_ps(&out[i + 3].X, w);
+			}
+
+			for (; i < count; i++)
+				out[i] = ApproximateSlerp(a[i], b[i], step);
+		}
 	}
 }
\ No newline at end of file
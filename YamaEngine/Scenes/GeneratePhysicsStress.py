@@ -0,0 +1,31 @@
+"""Writes the PhysicsStress scene: a floor with a grid of stacked dynamic boxes, used to benchmark the physics step.
+
+Usage: python GeneratePhysicsStress.py [boxes per side] > PhysicsStress.json
+"""
+import json
+import sys
+
+SIDE = int(sys.argv[1]) if len(sys.argv) > 1 else 8
+SPACING = 3.0
+HEIGHT_STEP = 2.5
+
+
+def entity(name, position, scale, tag, texture, extents, mass):
+    return {"Components": [
+        {"Name": name, "Position": position, "Rotation": [0.0, 0.0, 0.0], "Scale": scale, "Tag": tag, "Type": "Transform"},
+        {"Animations": None, "Path": "./Assets/Models/cube.fbx", "TexturePath": texture, "Type": "Mesh"},
+        {"ColliderType": "Box", "Extents": extents, "Mass": mass, "Offset": [0.0, 0.0, 0.0], "Type": "Physics"},
+    ]}
+
+
+entities = [entity("Base", [0.0, 0.0, 0.0], [0.4, 0.01, 0.4], "Floor", "./Assets/Textures/green.bmp", [40.0, 0.5, 40.0], 0.0)]
+start = -SPACING * (SIDE - 1) / 2
+for x in range(SIDE):
+    for z in range(SIDE):
+        for y in range(SIDE):
+            position = [start + x * SPACING, 1.5 + y * HEIGHT_STEP, start + z * SPACING]
+            entities.append(entity(f"Box {x} {z} {y}", position, [0.01, 0.01, 0.01], "Untagged", "./Assets/Textures/yellow.bmp", [1.0, 1.0, 1.0], 1.0))
+
+# One entity per line keeps the file small enough to review.
+lines = ",\n".join("        " + json.dumps(e) for e in entities)
+sys.stdout.write('{\n    "Entities": [\n' + lines + '\n    ]\n}\n')
@@ -0,0 +1,245 @@
+#ifdef GAME
+#include "Benchmark.h"
+
+// Using Try-Catch as the json library heavily relies on that.
+
+char const* Benchmark::GetPhaseName(BenchmarkPhase const phase)
+{
+	switch (phase)
+	{
+	case BenchmarkPhase::Scripts:
+		return "Scripts";
+	case BenchmarkPhase::PhysicsStep:
+		return "PhysicsStep";
+	case BenchmarkPhase::PhysicsResponse:
+		return "PhysicsResponse";
+	case BenchmarkPhase::RenderSync:
+		return "RenderSync";
+	case BenchmarkPhase::Draw:
+		return "Draw";
+	case BenchmarkPhase::Frame:
+		return "Frame";
+	default:
+		return "Unknown";
+	}
+}
+
+char const* Benchmark::GetCounterName(BenchmarkCounter const counter)
+{
+	switch (counter)
+	{
+	case BenchmarkCounter::ActiveBodies:
+		return "ActiveBodies";
+	case BenchmarkCounter::SleepingBodies:
+		return "SleepingBodies";
+	case BenchmarkCounter::BroadphasePairs:
+		return "BroadphasePairs";
+	case BenchmarkCounter::Manifolds:
+		return "Manifolds";
+	case BenchmarkCounter::ContactPoints:
+		return "ContactPoints";
+	case BenchmarkCounter::SolverIterations:
+		return "SolverIterations";
+	case BenchmarkCounter::Islands:
+		return "Islands";
+	default:
+		return "Unknown";
+	}
+}
+
+void Benchmark::Start(unsigned int const warmupFrames)
+{
+	mActive = true;
+	mWarmupFrames = warmupFrames;
+	mFrameCount = 0;
+	mFrameOpen = false;
+
+	for (auto& phaseTime : mCurrentFrame)
+		phaseTime = 0;
+	for (auto& samples : mSamples)
+		samples.clear();
+
+	mCountersSet = false;
+	for (auto& samples : mCounterSamples)
+		samples.clear();
+}
+
+void Benchmark::BeginFrame()
+{
+	if (!mActive)
+		return;
+
+	if (mFrameOpen)
+		StoreFrame();
+	mFrameOpen = true;
+}
+
+void Benchmark::EndFrames()
+{
+	if (mFrameOpen)
+		StoreFrame();
+	mFrameOpen = false;
+}
+
+void Benchmark::StoreFrame()
+{
+	bool measured = mFrameCount >= mWarmupFrames;
+	mFrameCount++;
+
+	for (size_t i = 0; i < PhaseCount; i++)
+	{
+		auto nanoseconds = mCurrentFrame[i].exchange(0, std::memory_order_relaxed);
+		if (measured)
+			mSamples[i].push_back(nanoseconds / 1'000'000.f);
+	}
+
+	if (measured && mCountersSet)
+	{
+		for (size_t i = 0; i < CounterCount; i++)
+			mCounterSamples[i].push_back(mCurrentCounters[i]);
+	}
+	mCountersSet = false;
+}
+
+Benchmark::json Benchmark::GetResults() const
+{
+	json results;
+	results["Frames"] = mSamples[0].size();
+	results["WarmupFrames"] = mWarmupFrames;
+
+	auto& phases = results["Phases"] = json::object();
+	for (size_t i = 0; i < PhaseCount; i++)
+	{
+		auto sorted = mSamples[i];
+		std::sort(sorted.begin(), sorted.end());
+
+		float mean = 0, p50 = 0, p99 = 0, max = 0;
+		if (!sorted.empty())
+		{
+			// Nearest-rank percentiles, so that every reported value is a real frame.
+			auto percentile = [&sorted](float const rank)
+			{
+				auto index = (size_t)std::ceil(rank * sorted.size());
+				return sorted[std::clamp<size_t>(index, 1, sorted.size()) - 1];
+			};
+
+			double total = 0;
+			for (auto const& sample : sorted)
+				total += sample;
+
+			mean = (float)(total / sorted.size());
+			p50 = percentile(0.5f);
+			p99 = percentile(0.99f);
+			max = sorted.back();
+		}
+
+		phases[GetPhaseName((BenchmarkPhase)i)] = { {"Mean", mean}, {"P50", p50}, {"P99", p99}, {"Max", max} };
+	}
+
+	// Counters are not compared against the baseline, they are there to explain the physics times.
+	auto& counters = results["PhysicsCounters"] = json::object();
+	for (size_t i = 0; i < CounterCount; i++)
+	{
+		auto const& samples = mCounterSamples[i];
+		double total = 0;
+		unsigned int max = 0;
+		for (auto const& sample : samples)
+		{
+			total += sample;
+			max = std::max(max, sample);
+		}
+
+		auto mean = samples.empty() ? 0.f : (float)(total / samples.size());
+		counters[GetCounterName((BenchmarkCounter)i)] = { {"Mean", mean}, {"Max", max} };
+	}
+	return results;
+}
+
+Benchmark::json Benchmark::FindRegressions(json const& results, json const& baseline, RegressionThresholds const& thresholds) const
+{
+	std::pair<char const*, float> const checks[] = {
+		{"Mean", thresholds.mMean},
+		{"P99", thresholds.mP99},
+		{"Max", thresholds.mMax}
+	};
+
+	auto regressions = json::array();
+	for (auto const& [phaseName, phaseResults] : results.at("Phases").items())
+	{
+		if (!baseline.at("Phases").contains(phaseName))
+		{
+			Log(LGR_WARNING, std::format("Baseline does not contain phase \"{}\", it will not be compared", phaseName));
+			continue;
+		}
+
+		auto const& phaseBaseline = baseline.at("Phases").at(phaseName);
+		for (auto const& [metric, threshold] : checks)
+		{
+			if (threshold <= 0)
+				continue;
+
+			auto current = phaseResults.at(metric).get<float>();
+			auto previous = phaseBaseline.at(metric).get<float>();
+			if (current - previous <= thresholds.mMinimumDifference || current <= previous * (1 + threshold))
+				continue;
+
+			Log(LGR_WARNING, std::format("Regression in {} {}: {:.3f}ms -> {:.3f}ms (allowed +{:.0f}%)", phaseName, metric, previous, current, threshold * 100));
+			regressions.push_back({ {"Phase", phaseName}, {"Metric", metric}, {"Baseline", previous}, {"Current", current} });
+		}
+	}
+	return regressions;
+}
+
+bool Benchmark::Report(RunSettings const& settings) const
+{
+	auto results = GetResults();
+	results["Scene"] = settings.mStartScene;
+
+	bool passed = true;
+	if (!settings.mBaselinePath.empty())
+	{
+		std::ifstream baselineFile(settings.mBaselinePath);
+		if (baselineFile.fail())
+		{
+			Log(LGR_ERROR, std::format("Could not load the benchmark baseline at \"{}\"", settings.mBaselinePath));
+			passed = false;
+		}
+		else
+		{
+			try
+			{
+				auto regressions = FindRegressions(results, json::parse(baselineFile), settings.mThresholds);
+				passed = regressions.empty();
+				results["Regressions"] = std::move(regressions);
+			}
+			catch (std::exception const& e)
+			{
+				Log(LGR_ERROR, std::format("Exception occurred when comparing against the benchmark baseline at \"{}\". Exception: {}", settings.mBaselinePath, e.what()));
+				passed = false;
+			}
+		}
+	}
+
+	for (auto const& [phaseName, phaseResults] : results["Phases"].items())
+	{
+		Log(LGR_INFO, std::format("{}: mean {:.3f}ms, p50 {:.3f}ms, p99 {:.3f}ms, max {:.3f}ms", phaseName,
+			phaseResults["Mean"].get<float>(), phaseResults["P50"].get<float>(), phaseResults["P99"].get<float>(), phaseResults["Max"].get<float>()));
+	}
+
+	std::ofstream file(settings.mBenchmarkPath);
+	if (file.fail())
+	{
+		Log(LGR_ERROR, std::format("Could not save the benchmark results to \"{}\"", settings.mBenchmarkPath));
+		return false;
+	}
+
+	file << results.dump(4);
+	file.close();
+	Log(LGR_INFO, std::format("Saved the benchmark results of {} frames to \"{}\"", results["Frames"].get<size_t>(), settings.mBenchmarkPath));
+
+	if (!passed)
+		Log(LGR_ERROR, "Benchmark did not pass the comparison against the baseline");
+
+	return passed;
+}
+#endif // GAME
@@ -193,6 +193,20 @@ nlohmann::json PhysicsEditorComponent::GetJsonedObject()
 	jObject["ColliderType"] = mColliderType;
 	jObject["Mass"] = mMass;
 
+	if (!mLayer.empty())
+		jObject["Layer"] = mLayer;
+
+	if (mTrigger)
+		jObject["Trigger"] = mTrigger;
+
+	if (mKinematic)
+		jObject["Kinematic"] = mKinematic;
+
+	if (!mMerge)
+		jObject["Merge"] = mMerge;
+
+	// Only the parameters of the used shape are saved.
+	if (mColliderType == "Box")
 	{
 		json extenObj;
 
@@ -203,6 +217,22 @@ nlohmann::json PhysicsEditorComponent::GetJsonedObject()
 		jObject["Extents"] = extenObj;
 	}
 
+	if (mColliderType == "Sphere" || mColliderType == "Capsule")
+		jObject["Radius"] = mRadius;
+
+	if (mColliderType == "Capsule")
+		jObject["Height"] = mHeight;
+
+	if (mColliderType == "ConvexHull" || mColliderType == "TriangleMesh")
+	{
+		jObject["Mesh"] = mMeshPath;
+		if (mScale.X != 1 || mScale.Y != 1 || mScale.Z != 1)
+			jObject["Scale"] = { mScale.X, mScale.Y, mScale.Z };
+	}
+
+	if (mColliderType == "Compound")
+		jObject["Children"] = mChildren.is_array() ? mChildren : json::array();
+
 	{
 		json offsetObj;
 		offsetObj.emplace_back(mOffsets.X);
@@ -221,6 +251,10 @@ void PhysicsEditorComponent::PopulateFromJson(nlohmann::json const& jObject)
 	{
 		mColliderType = jObject["ColliderType"].get<std::string>();
 		mMass = jObject["Mass"].get<float>();
+		mLayer = jObject.value("Layer", "");
+		mTrigger = jObject.value("Trigger", false);
+		mKinematic = jObject.value("Kinematic", false);
+		mMerge = jObject.value("Merge", true);
 
 		{ // Offset
 			auto& offsets = jObject["Offset"];
@@ -229,7 +263,21 @@ void PhysicsEditorComponent::PopulateFromJson(nlohmann::json const& jObject)
 			mOffsets.Z = offsets.at(2).get<float>();
 		}
 
-		{ // Extents
+		mRadius = jObject.value("Radius", 0.f);
+		mHeight = jObject.value("Height", 0.f);
+		mMeshPath = jObject.value("Mesh", "");
+		mChildren = jObject.value("Children", json::array());
+
+		if (jObject.contains("Scale"))
+		{
+			auto& scale = jObject["Scale"];
+			mScale.X = scale.at(0).get<float>();
+			mScale.Y = scale.at(1).get<float>();
+			mScale.Z = scale.at(2).get<float>();
+		}
+
+		if (jObject.contains("Extents"))
+		{
 			auto& extents = jObject["Extents"];
 			mExtents.X = extents.at(0).get<float>();
 			mExtents.Y = extents.at(1).get<float>();
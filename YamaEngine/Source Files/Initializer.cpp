@@ -35,6 +35,102 @@ std::pair<unsigned int, unsigned int> Initializer::GetResolution()
 	return { width  , height };
 }
 
+int Initializer::GetWorkerThreadCount()
+{
+	int workerThreads = -1;
+	try
+	{
+		auto& threadsJson = mConfigDocument["Settings"]["WorkerThreads"];
+		if (!threadsJson.is_null())
+			workerThreads = threadsJson.get<int>();
+	}
+	catch (std::exception const& e)
+	{
+		Log(LGR_ERROR, std::format("Exception occurred while parsing json for worker threads: {}", e.what()));
+	}
+	return workerThreads;
+}
+
+TimeSettings Initializer::GetTimeSettings()
+{
+	TimeSettings settings;
+	ReadTimeSettings(settings, mConfigDocument["Time"]);
+	return settings;
+}
+
+void Initializer::ReadTimeSettings(TimeSettings& settings, json const& timeJson)
+{
+	if (!timeJson.is_object())
+		return;
+
+	try
+	{
+		if (timeJson.contains("FixedStep"))
+			settings.mFixedStep = timeJson["FixedStep"].get<float>();
+
+		if (timeJson.contains("MaxSubsteps"))
+			settings.mMaxSubsteps = timeJson["MaxSubsteps"].get<unsigned int>();
+
+		if (timeJson.contains("TimeScale"))
+			settings.mTimeScale = timeJson["TimeScale"].get<float>();
+
+		if (timeJson.contains("TargetFrameRate"))
+			settings.mTargetFrameRate = timeJson["TargetFrameRate"].get<float>();
+
+		if (timeJson.contains("FrameLimiter"))
+			settings.mLimiter = LimiterNameToMode(timeJson["FrameLimiter"].get<std::string>());
+	}
+	catch (std::exception const& e)
+	{
+		Log(LGR_ERROR, std::format("Exception occurred while parsing json for time settings: {}", e.what()));
+		Log(LGR_WARNING, "Used data might be mixed between the default data and read data");
+	}
+}
+
+RunSettings Initializer::GetRunSettings()
+{
+	RunSettings settings;
+	// The sections are independent, a benchmark can be configured without the headless run.
+	auto headlessJson = mConfigDocument["Headless"];
+	if (!headlessJson.is_null())
+	{
+		try
+		{
+			settings.mHeadless = headlessJson["Enabled"].get<bool>();
+			settings.mDriver = DriverNameToType(headlessJson["Driver"].get<std::string>());
+			settings.mFrameLimit = headlessJson["FrameLimit"].get<unsigned int>();
+			settings.mSecondsLimit = headlessJson["SecondsLimit"].get<float>();
+			settings.mStartScene = headlessJson["StartScene"].get<int>();
+		}
+		catch (std::exception const& e)
+		{
+			Log(LGR_ERROR, std::format("Exception occurred while parsing json for headless settings: {}", e.what()));
+			Log(LGR_WARNING, "Used data might be mixed between the default data and read data");
+		}
+	}
+
+	auto benchmarkJson = mConfigDocument["Benchmark"];
+	if (!benchmarkJson.is_null())
+	{
+		try
+		{
+			settings.mWarmupFrames = benchmarkJson["WarmupFrames"].get<unsigned int>();
+			auto& thresholds = settings.mThresholds;
+			thresholds.mMean = benchmarkJson["MeanThreshold"].get<float>();
+			thresholds.mP99 = benchmarkJson["P99Threshold"].get<float>();
+			thresholds.mMax = benchmarkJson["MaxThreshold"].get<float>();
+			thresholds.mMinimumDifference = benchmarkJson["MinimumDifferenceMs"].get<float>();
+		}
+		catch (std::exception const& e)
+		{
+			Log(LGR_ERROR, std::format("Exception occurred while parsing json for benchmark settings: {}", e.what()));
+			Log(LGR_WARNING, "Used data might be mixed between the default data and read data");
+		}
+	}
+
+	return settings;
+}
+
 void Initializer::LoadLoggingFiles()
 {
 	auto fileLogs = mConfigDocument["LoggingFiles"];
@@ -103,6 +199,120 @@ void Initializer::LoadScenesConfigs()
 	}
 }
 
+std::vector<CollisionLayer> Initializer::GetCollisionLayers()
+{
+	// Bullet stores the filter in an int, the sign bit is left out.
+	constexpr size_t MaxLayers = 31;
+
+	std::vector<CollisionLayer> layers;
+	auto layersJson = mConfigDocument["Physics"]["Layers"];
+	if (layersJson.is_null())
+		return layers;
+
+	std::vector<std::vector<std::string>> collidesWith;
+	try
+	{
+		for (auto& item : layersJson)
+		{
+			if (layers.size() == MaxLayers)
+			{
+				Log(LGR_ERROR, std::format("Only {} collision layers are supported, the rest are ignored", MaxLayers));
+				break;
+			}
+
+			CollisionLayer layer;
+			layer.mName = item["Name"].get<std::string>();
+			layer.mGroup = 1 << layers.size();
+			layers.emplace_back(std::move(layer));
+			collidesWith.emplace_back(item["CollidesWith"].get<std::vector<std::string>>());
+		}
+	}
+	catch (std::exception const& e)
+	{
+		Log(LGR_ERROR, std::format("Exception occurred while parsing json for collision layers: {}", e.what()));
+		Log(LGR_WARNING, "Collision layers are not used");
+		return {};
+	}
+
+	for (size_t i = 0; i < collidesWith.size(); i++)
+	{
+		for (auto& otherName : collidesWith[i])
+		{
+			auto other = std::find_if(layers.begin(), layers.end(), [&otherName](auto const& layer) { return layer.mName == otherName; });
+			if (other == layers.end())
+			{
+				Log(LGR_WARNING, std::format("Collision layer \"{}\" lists an unknown layer \"{}\"", layers[i].mName, otherName));
+				continue;
+			}
+
+			// Bullet requires both of the layers to accept the pair, so the matrix is mirrored.
+			layers[i].mMask |= other->mGroup;
+			other->mMask |= layers[i].mGroup;
+		}
+	}
+
+	return layers;
+}
+
+int Initializer::GetPhysicsThreadCount()
+{
+	int physicsThreads = 1;
+	try
+	{
+		auto& threadsJson = mConfigDocument["Physics"]["Threads"];
+		if (!threadsJson.is_null())
+			physicsThreads = threadsJson.get<int>();
+	}
+	catch (std::exception const& e)
+	{
+		Log(LGR_ERROR, std::format("Exception occurred while parsing json for physics threads: {}", e.what()));
+	}
+	return physicsThreads;
+}
+
+bool Initializer::BakeColliders()
+{
+	std::vector<std::string> meshPaths;
+	for (auto const& scene : mAvailableScene)
+	{
+		std::ifstream sceneFile(scene.mConfigPath);
+		if (sceneFile.fail())
+		{
+			Log(LGR_ERROR, std::format("Could not load the scene file at \"{}\"", scene.mConfigPath));
+			continue;
+		}
+
+		try
+		{
+			auto sceneJson = json::parse(sceneFile);
+			for (auto& entityJson : sceneJson["Entities"])
+			{
+				for (auto& componentJson : entityJson["Components"])
+				{
+					if (componentJson["Type"].get<std::string>() != "Physics" || componentJson.value("ColliderType", "") != "TriangleMesh")
+						continue;
+
+					ShapeDescription shape;
+					// Every scale shares the BVH of the unscaled mesh, so only the paths are needed.
+					if (ReadShapeDescription(componentJson, shape) && std::find(meshPaths.begin(), meshPaths.end(), shape.mMeshPath) == meshPaths.end())
+						meshPaths.push_back(shape.mMeshPath);
+				}
+			}
+		}
+		catch (std::exception const& e)
+		{
+			Log(LGR_ERROR, std::format("Exception occurred when parsing the json in scene file at \"{}\". Exception: {}", scene.mConfigPath, e.what()));
+		}
+	}
+
+	bool baked = true;
+	for (auto const& meshPath : meshPaths)
+		baked = mPhysics->BakeTriangleMesh(meshPath) && baked;
+
+	Log(LGR_INFO, std::format("Baked {} triangle mesh colliders", meshPaths.size()));
+	return baked;
+}
+
 std::optional<SceneObject> Initializer::GetSceneById(unsigned int const id)
 {
 	std::optional<SceneObject> selectedScene = {};
@@ -149,6 +359,12 @@ void Initializer::LoadSceneById(unsigned int const sceneId, entt::registry& regi
 
 	PopulateRegistry(registry, sceneJson);
 	mCurrentScene = sceneId;
+
+	// Scenes can have a different pace, e.g. a physics heavy level might need a smaller step.
+	mSceneTimeSettings = GetTimeSettings();
+	if (sceneJson.contains("Time"))
+		ReadTimeSettings(mSceneTimeSettings, sceneJson["Time"]);
+
 	Log(LGR_INFO, std::format("Loaded successfully scene with an ID {}", sceneId));
 }
 #endif // GAME
@@ -267,6 +483,10 @@ void Initializer::PopulateRegistry(entt::registry& registry, json const& jScene)
 			}
 		}
 	}
+
+#ifdef GAME
+	MergeStaticColliders(registry);
+#endif // GAME
 }
 
 void Initializer::PopulateWithTransform(entt::registry& registry, entt::entity& entity, json const& transformComponentJson)
@@ -323,10 +543,8 @@ void Initializer::PopulateWithTransform(entt::registry& registry, entt::entity&
 		{
 			Log(LGR_ERROR, "The rotation variable was not an array therefore it was skipped and the default was used");
 		}
-		auto& rot = newTransform.mRotation;
-		rot.X = x;
-		rot.Y = y;
-		rot.Z = z;
+		// Scene files keep the Euler angles in degrees, as they are easier to edit by hand.
+		newTransform.mRotation = yamath::opr::FromEuler({ x, y, z });
 	}
 #pragma endregion
 
@@ -359,20 +577,22 @@ void Initializer::PopulateWithTransform(entt::registry& registry, entt::entity&
 	}
 #pragma endregion
 
+	Identity newIdentity;
 	try
 	{
-		newTransform.mName = transformComponentJson["Name"].get<std::string>();
-		newTransform.mTag = transformComponentJson["Tag"].get<std::string>();;
+		newIdentity.mName = transformComponentJson["Name"].get<std::string>();
+		newIdentity.mTag = transformComponentJson["Tag"].get<std::string>();;
 	}
 	catch (std::exception const& e)
 	{
 		Log(LGR_ERROR, std::format("Issues while trying to retrieve a name and or the tag from scene file {}", e.what()));
-		newTransform.mName = "Game object";
-		newTransform.mTag = "";
+		newIdentity.mName = "Game object";
+		newIdentity.mTag = "";
 	}
 
 	// Either this, or create it at the beginning, take returned reference and populate it that way
-	registry.emplace<Transform>(entity, std::move(newTransform));
+	registry.emplace<Transform>(entity, newTransform);
+	registry.emplace<Identity>(entity, std::move(newIdentity));
 }
 
 void Initializer::PopulateWithMesh(entt::registry& registry, entt::entity& entity, json const& meshComponentJson)
@@ -441,8 +661,9 @@ void Initializer::PopulateWithMesh(entt::registry& registry, entt::entity& entit
 #ifdef GAME
 void Initializer::PopulateWithPhysics(entt::registry& registry, entt::entity& entity, json const& physicsComponentJson)
 {
-	std::string colliderType;
+	std::string colliderType, layerName;
 	float mass, offsetX, offsetY, offsetZ;
+	bool trigger, kinematic;
 
 	try
 	{
@@ -453,6 +674,10 @@ void Initializer::PopulateWithPhysics(entt::registry& registry, entt::entity& en
 		offsetY = offsets.at(1).get<float>();
 		offsetZ = offsets.at(2).get<float>();
 
+		// Bodies without a layer are split into the moving and the static ones.
+		layerName = physicsComponentJson.value("Layer", mass == 0 ? "Static" : "Default");
+		trigger = physicsComponentJson.value("Trigger", false);
+		kinematic = physicsComponentJson.value("Kinematic", false);
 	}
 	catch (std::exception const& e)
 	{
@@ -460,30 +685,178 @@ void Initializer::PopulateWithPhysics(entt::registry& registry, entt::entity& en
 		return;
 	}
 
-	if (colliderType == "Box")
+	auto layer = mPhysics->FindCollisionLayer(layerName);
+	if (layer < 0 && physicsComponentJson.contains("Layer"))
+		Log(LGR_ERROR, std::format("Could not find the collision layer \"{}\", default filters are used", layerName));
+
+	ShapeDescription shape;
+	if (!ReadShapeDescription(physicsComponentJson, shape))
+		return;
+
+	// Colliders that never move are merged once the whole scene is read. Triangle meshes already have their own BVH.
+	// Compounds are not merged, as Bullet would report the index of their own child, which could not be mapped to the entity.
+	bool mergeable = mass == 0 && !trigger && !kinematic && shape.mType != TriangleMesh && shape.mType != Compound && physicsComponentJson.value("Merge", true);
+	if (mergeable)
 	{
-		float extentX, extentY, extentZ;
+		// The shape is created now, so that an invalid one is reported the same way as for the other bodies.
+		if (!mPhysics->GetShape(shape))
+		{
+			Log(LGR_ERROR, std::format("Could not create the {} collider, the physics component is skipped", colliderType));
+			return;
+		}
 
-		try
+		mPendingStatics.push_back({ entity, std::move(shape), { offsetX, offsetY, offsetZ }, layer });
+		return;
+	}
+
+	// Triggers only report the overlaps, so the mass is not used
+	auto physicsComp = trigger
+		? mPhysics->CreateTrigger(shape, { offsetX, offsetY, offsetZ }, (int)entity, layer)
+		: mPhysics->CreatePhysicsBody(shape, mass, { offsetX, offsetY, offsetZ }, (int)entity, layer, kinematic);
+
+	if (physicsComp.has_value())
+		registry.emplace<PhysicalBody>(entity, std::move(physicsComp.value()));
+	else
+		Log(LGR_ERROR, std::format("Could not create the {} collider, the physics component is skipped", colliderType));
+}
+
+void Initializer::MergeStaticColliders(entt::registry& registry)
+{
+	std::unordered_map<int, std::vector<PendingStaticCollider*>> layers;
+	for (auto& pending : mPendingStatics)
+	{
+		// Scripted entities might move their colliders, so they keep their own bodies.
+		if (registry.all_of<GameLogic>(pending.mEntity))
 		{
-			auto& extents = physicsComponentJson["Extents"];
-			extentX = extents.at(0).get<float>();
-			extentY = extents.at(1).get<float>();
-			extentZ = extents.at(2).get<float>();
+			auto body = mPhysics->CreatePhysicsBody(pending.mShape, 0, pending.mOffset, (int)pending.mEntity, pending.mLayer);
+			if (body.has_value())
+				registry.emplace<PhysicalBody>(pending.mEntity, std::move(body.value()));
+			continue;
 		}
-		catch (std::exception const& e)
+
+		layers[pending.mLayer].push_back(&pending);
+	}
+
+	size_t mergedCount = 0, mergedBodies = 0;
+	for (auto& [layer, colliders] : layers)
+	{
+		if (colliders.size() == 1)
+		{
+			auto& pending = *colliders.front();
+			auto body = mPhysics->CreatePhysicsBody(pending.mShape, 0, pending.mOffset, (int)pending.mEntity, layer);
+			if (body.has_value())
+				registry.emplace<PhysicalBody>(pending.mEntity, std::move(body.value()));
+			continue;
+		}
+
+		// The children are placed the same way as a body of their own, the offset is not rotated with the entity.
+		ShapeDescription compound;
+		compound.mType = Compound;
+		std::vector<int> childEntities;
+		for (auto* pending : colliders)
 		{
-			Log(LGR_ERROR, std::format("Exception occurred while getting the Collider extents from scene file: {}", e.what()));
+			Transform transform;
+			if (auto* entityTransform = registry.try_get<Transform>(pending->mEntity))
+				transform = *entityTransform;
+
+			compound.mChildren.push_back({ pending->mShape, yamath::opr::Add(transform.mPosition, pending->mOffset), transform.mRotation });
+			childEntities.push_back((int)pending->mEntity);
 		}
 
-		auto physicsComp = mPhysics->CreatePhysicsCube({ extentX, extentY, extentZ }, mass, { offsetX, offsetY, offsetZ }, (int)entity);
-		registry.emplace<PhysicalBody>(entity, std::move(physicsComp));
+		auto body = mPhysics->CreateMergedStaticBody(compound, std::move(childEntities), layer);
+		if (!body.has_value())
+			continue;
+
+		auto entity = registry.create();
+		registry.emplace<Transform>(entity);
+		registry.emplace<Identity>(entity, "Merged static colliders", "");
+		registry.emplace<PhysicalBody>(entity, std::move(body.value()));
+		mergedCount += colliders.size();
+		mergedBodies++;
 	}
 
-	else
+	if (mergedCount > 0)
+		Log(LGR_INFO, std::format("Merged {} static colliders into {} bodies", mergedCount, mergedBodies));
+
+	mPendingStatics.clear();
+}
+
+bool Initializer::ReadShapeDescription(json const& shapeJson, ShapeDescription& shape)
+{
+	std::string colliderType;
+	try
 	{
-		Log(LGR_ERROR, std::format("Could not determine the collider type: {}", colliderType));
+		colliderType = shapeJson["ColliderType"].get<std::string>();
+
+		if (colliderType == "Box")
+		{
+			auto& extents = shapeJson["Extents"];
+			shape.mType = Box;
+			shape.mExtents = { extents.at(0).get<float>(), extents.at(1).get<float>(), extents.at(2).get<float>() };
+		}
+
+		else if (colliderType == "Sphere")
+		{
+			shape.mType = Sphere;
+			shape.mRadius = shapeJson["Radius"].get<float>();
+		}
+
+		else if (colliderType == "Capsule")
+		{
+			shape.mType = Capsule;
+			shape.mRadius = shapeJson["Radius"].get<float>();
+			shape.mHeight = shapeJson["Height"].get<float>();
+		}
+
+		else if (colliderType == "ConvexHull" || colliderType == "TriangleMesh")
+		{
+			shape.mType = colliderType == "ConvexHull" ? ConvexHull : TriangleMesh;
+			shape.mMeshPath = shapeJson["Mesh"].get<std::string>();
+			if (shapeJson.contains("Scale"))
+			{
+				auto& scale = shapeJson["Scale"];
+				shape.mScale = { scale.at(0).get<float>(), scale.at(1).get<float>(), scale.at(2).get<float>() };
+			}
+		}
+
+		else if (colliderType == "Compound")
+		{
+			shape.mType = Compound;
+			for (auto& childJson : shapeJson["Children"])
+			{
+				CompoundChild child;
+				if (!ReadShapeDescription(childJson, child.mShape))
+					continue;
+
+				if (childJson.contains("Offset"))
+				{
+					auto& offset = childJson["Offset"];
+					child.mOffset = { offset.at(0).get<float>(), offset.at(1).get<float>(), offset.at(2).get<float>() };
+				}
+
+				if (childJson.contains("Rotation"))
+				{
+					auto& rotation = childJson["Rotation"];
+					child.mRotation = yamath::opr::FromEuler({ rotation.at(0).get<float>(), rotation.at(1).get<float>(), rotation.at(2).get<float>() });
+				}
+
+				shape.mChildren.push_back(std::move(child));
+			}
+		}
+
+		else
+		{
+			Log(LGR_ERROR, std::format("Could not determine the collider type: {}", colliderType));
+			return false;
+		}
 	}
+	catch (std::exception const& e)
+	{
+		Log(LGR_ERROR, std::format("Exception occurred while getting the {} collider shape from scene file: {}", colliderType, e.what()));
+		return false;
+	}
+
+	return true;
 }
 
 void Initializer::PopulateWithScripts(entt::registry& registry, entt::entity& entity, json const& scriptComponentJson)
@@ -495,7 +868,7 @@ void Initializer::PopulateWithScripts(entt::registry& registry, entt::entity& en
 		try
 		{
 			auto type = item.get<std::string>();
-			component.AddScript(type);
+			component.AddScript(registry, entity, type);
 		}
 		catch (std::exception const& e)
 		{
@@ -690,7 +1063,7 @@ void Initializer::LoadEditor(entt::registry& editorRegistry)
 		for (auto& scriptNameRaw : editorData["EditorScripts"])
 		{
 			auto scriptName = scriptNameRaw.get<std::string>();
-			scriptManager.AddScript(scriptName);
+			scriptManager.AddScript(editorRegistry, entity, scriptName);
 		}
 	}
 	catch (std::exception const& e)
@@ -0,0 +1,159 @@
+#ifdef GAME
+#include "Replay.h"
+
+// Using Try-Catch as the json library heavily relies on that.
+
+/**
+ * @brief Bit flags for the mouse buttons, to keep the file smaller.
+*/
+enum ReplayButtons
+{
+	ReplayLMB = 1,
+	ReplayRMB = 2,
+	ReplayMMB = 4
+};
+
+void ReplayRecorder::Begin(unsigned int const seed, int const startScene, float const fixedStep)
+{
+	mData = ReplayData();
+	mData.mSeed = seed;
+	mData.mStartScene = startScene;
+	mData.mFixedStep = fixedStep;
+}
+
+void ReplayRecorder::RecordStep(Input::InputState const& state)
+{
+	if (mData.mInputRuns.empty() || !(mData.mInputRuns.back().mState == state))
+		mData.mInputRuns.emplace_back(ReplayData::InputRun{ .mState = state, .mCount = 0 });
+
+	mData.mInputRuns.back().mCount++;
+	mData.mStepCount++;
+}
+
+void ReplayRecorder::RecordSceneChange(int const sceneId)
+{
+	mData.mSceneChanges.emplace_back(mData.mStepCount, sceneId);
+}
+
+void ReplayRecorder::Save(std::string const& path) const
+{
+	json document;
+	document["Seed"] = mData.mSeed;
+	document["StartScene"] = mData.mStartScene;
+	document["FixedStep"] = mData.mFixedStep;
+	document["StepCount"] = mData.mStepCount;
+
+	auto& sceneChanges = document["SceneChanges"] = json::array();
+	for (auto const& [step, sceneId] : mData.mSceneChanges)
+		sceneChanges.push_back({ {"Step", step}, {"Scene", sceneId} });
+
+	auto& inputRuns = document["Input"] = json::array();
+	for (auto const& run : mData.mInputRuns)
+	{
+		auto const& state = run.mState;
+		int buttons = (state.mLMB ? ReplayLMB : 0) | (state.mRMB ? ReplayRMB : 0) | (state.mMMB ? ReplayMMB : 0);
+
+		inputRuns.push_back({ {"Count", run.mCount},
+							  {"Keys", state.mPressedKeys},
+							  {"Buttons", buttons},
+							  {"Mouse", {state.mMouseXRel, state.mMouseYRel}},
+							  {"Scroll", state.mScroll} });
+	}
+
+	std::ofstream file(path);
+	if (file.fail())
+	{
+		Log(LGR_ERROR, std::format("Could not save the replay to \"{}\"", path));
+		return;
+	}
+
+	file << document.dump(4);
+	file.close();
+	Log(LGR_INFO, std::format("Saved a replay of {} steps to \"{}\"", mData.mStepCount, path));
+}
+
+bool ReplayPlayer::Load(std::string const& path)
+{
+	std::ifstream file(path);
+	if (file.fail())
+	{
+		Log(LGR_ERROR, std::format("Could not load the replay file at \"{}\"", path));
+		return false;
+	}
+
+	try
+	{
+		auto document = json::parse(file);
+		mData = ReplayData();
+		mData.mSeed = document["Seed"].get<unsigned int>();
+		mData.mStartScene = document["StartScene"].get<int>();
+		mData.mFixedStep = document["FixedStep"].get<float>();
+		mData.mStepCount = document["StepCount"].get<unsigned long long>();
+
+		for (auto const& sceneChange : document["SceneChanges"])
+			mData.mSceneChanges.emplace_back(sceneChange["Step"].get<unsigned long long>(), sceneChange["Scene"].get<int>());
+
+		for (auto const& runJson : document["Input"])
+		{
+			ReplayData::InputRun run;
+			run.mCount = runJson["Count"].get<unsigned int>();
+
+			auto& state = run.mState;
+			state.mPressedKeys = runJson["Keys"].get<std::vector<int>>();
+			auto buttons = runJson["Buttons"].get<int>();
+			state.mLMB = buttons & ReplayLMB;
+			state.mRMB = buttons & ReplayRMB;
+			state.mMMB = buttons & ReplayMMB;
+			state.mMouseXRel = runJson["Mouse"].at(0).get<float>();
+			state.mMouseYRel = runJson["Mouse"].at(1).get<float>();
+			state.mScroll = runJson["Scroll"].get<float>();
+
+			mData.mInputRuns.emplace_back(std::move(run));
+		}
+	}
+	catch (std::exception const& e)
+	{
+		Log(LGR_ERROR, std::format("Exception occurred when parsing the replay file at \"{}\". Exception: {}", path, e.what()));
+		return false;
+	}
+
+	mRunIndex = 0;
+	mRunStep = 0;
+	mStep = 0;
+	mSceneChangeIndex = 0;
+
+	Log(LGR_INFO, std::format("Loaded a replay of {} steps from \"{}\"", mData.mStepCount, path));
+	return true;
+}
+
+bool ReplayPlayer::NextStep(Input::InputState& state)
+{
+	// Skip the runs that are used up.
+	while (mRunIndex < mData.mInputRuns.size() && mRunStep >= mData.mInputRuns[mRunIndex].mCount)
+	{
+		mRunIndex++;
+		mRunStep = 0;
+	}
+
+	if (IsFinished() || mRunIndex >= mData.mInputRuns.size())
+		return false;
+
+	state = mData.mInputRuns[mRunIndex].mState;
+	mRunStep++;
+	mStep++;
+	return true;
+}
+
+std::optional<int> ReplayPlayer::PopSceneChange()
+{
+	if (mSceneChangeIndex >= mData.mSceneChanges.size())
+		return {};
+
+	auto const& [step, sceneId] = mData.mSceneChanges[mSceneChangeIndex];
+	if (step > mStep)
+		return {};
+
+	mSceneChangeIndex++;
+	return sceneId;
+}
+#endif // GAME
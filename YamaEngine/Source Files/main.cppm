@@ -12,4 +12,6 @@ int main(int argc, char* argv[])
 	yamaEngine.GameLoop();
 
 	yamaEngine.Cleanup();
+
+	return yamaEngine.GetExitCode();
 }
\ No newline at end of file